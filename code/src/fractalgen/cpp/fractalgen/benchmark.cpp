@@ -0,0 +1,587 @@
+#include "fractalgen/benchmark.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "fractalgen/generators/factory.hpp"
+#include "fractalgen/kernels/kernels.hpp"
+#include "fractalgen/kernels/targets.hpp"
+#include "fractalgen/numbers/bigfloat.hpp"
+#include "fractalgen/simd/isa.hpp"
+
+namespace fractalgen::benchmark
+{
+
+    static constexpr uint64_t c_seed = 0x5eed;
+
+    // arguments to exp cover everything the powertower kernel can produce (see fractalgen/kernels/powertower.hpp)
+    static constexpr double c_exp_real = 700.0;
+    static constexpr double c_exp_imag = 75000.0;
+    static constexpr double c_exp_max_ulp = 4.0;
+
+    // the settings (and default bounds) the powertower generator renders with
+    static constexpr int c_powertower_cap = 200;
+    static constexpr double c_powertower_mag_cap = 50;
+    static constexpr double c_powertower_tolerance = 1e-10;
+    static constexpr double c_powertower_bounds[] = { -5.2, -1.75, 1.0, 1.75 };
+
+    // bigfloat results rounded to double may be a unit off the correctly rounded double (they are truncated first)
+    static constexpr double c_bigfloat_max_ulp = 1.0;
+    static constexpr int c_bigfloat_thirds = 600;          // 1 - 3 * 0.333... with this many digits is 10^-600
+
+    // perturbation offsets around a point of the seahorse valley, compared against the same offsets scaled far below
+    // the range of double. batches are the size of the smallest tile the generators compute
+    static constexpr double c_perturbation_center[] = { -0.743643887037158, 0.131825904205312 };
+    static constexpr double c_perturbation_radius = 1e-7;
+    static constexpr int c_perturbation_cap = 500;
+    static constexpr int64_t c_perturbation_exponent = -1000;
+    static constexpr size_t c_perturbation_batch = 256;
+    static constexpr int c_perturbation_runs = 3;
+
+    // offsets around the tip of the set, small enough that the series approximation covers most of every orbit
+    static constexpr double c_series_center[] = { -2.0, 0.0 };
+    static constexpr double c_series_radius = 1e-200;
+
+    // the settings the mandelbrot generator renders with, over a view of the boundary (the default bounds are mostly
+    // resolved by the interior tests). automatic precision iterates both this view and the powertower's default
+    // bounds in float at the default sample count
+    static constexpr int c_mandelbrot_cap = 500;
+    static constexpr double c_mandelbrot_tolerance = 1e-10;
+    static constexpr double c_mandelbrot_bounds[] = { -1.5, -0.5, -0.5, 0.5 };
+
+    // a view of the seahorse valley past the range of double, where the mandelbrot generator has to raise its cap to
+    // see anything but the set. at most this fraction of the samples may reach the cap, and the escaped ones have to
+    // spread over at least this fraction as many distinct iteration counts
+    static constexpr char const* c_deep_center[] = { "-0.743643887037158704752191506114774", "0.131825904205311970493132056385139" };
+    static constexpr char const* c_deep_scale = "1e-25";
+    static constexpr double c_deep_max_bounded = 0.5;
+    static constexpr double c_deep_min_distinct = 1.0 / 64;
+
+    static constexpr simd::isa c_isas[] = { simd::isa::scalar, simd::isa::avx2, simd::isa::avx512 };
+
+    template<typename Func>
+    static double seconds(Func func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the powertower iteration exactly as written before it was vectorized
+    static kernels::escape_t reference_powertower(std::complex<double> const& num)
+    {
+        if (num == 0.0) { return { 0, true }; }
+
+        std::complex<double> log_num = std::log(std::complex<double>(num.real(), num.imag() + 0.0));
+        std::complex<double> z = num;
+        int i;
+        for (i = 0; i < c_powertower_cap && std::abs(z) < c_powertower_mag_cap; i++)
+        {
+            z = std::exp(z * log_num);
+        }
+        if (std::abs(z) < c_powertower_mag_cap) { return { c_powertower_cap, true }; }
+        else { return { i, false }; }
+    }
+
+    static bool exp_accuracy(size_t samples)
+    {
+        std::mt19937_64 rng(c_seed);
+        std::uniform_real_distribution<double> real(-c_exp_real, c_exp_real);
+        std::uniform_real_distribution<double> imag(-c_exp_imag, c_exp_imag);
+
+        std::vector<std::complex<double>> points(samples);
+        for (std::complex<double>& point : points) { point = { real(rng), imag(rng) }; }
+
+        std::vector<std::complex<double>> expected(samples);
+        double reference = seconds([&]() { for (size_t k = 0; k < samples; ++k) { expected[k] = std::exp(points[k]); } });
+
+        std::cout << "complex exp over " << samples << " arguments with |re| <= " << c_exp_real << " and |im| <= " << c_exp_imag
+            << " (std::exp: " << 1e9 * reference / samples << " ns per call)" << std::endl;
+
+        bool success = true;
+        std::vector<std::complex<double>> results(samples);
+        for (simd::isa target : c_isas)
+        {
+            if (!simd::supported(target)) { continue; }
+            simd::select(target);
+
+            double elapsed = seconds([&]() { kernels::exp(points, results); });
+
+            // error relative to the magnitude of the result, in units of DBL_EPSILON
+            double max_ulp = 0.0;
+            for (size_t k = 0; k < samples; ++k)
+            {
+                max_ulp = std::max(max_ulp, std::abs(results[k] - expected[k]) / (std::abs(expected[k]) * DBL_EPSILON));
+            }
+            success = success && max_ulp <= c_exp_max_ulp;
+
+            std::cout << "  " << std::setw(6) << simd::name(target) << ": max error " << max_ulp << " ulp, "
+                << 1e9 * elapsed / samples << " ns per call" << std::endl;
+        }
+        return success;
+    }
+
+    // distance from expected to actual in units of the spacing of doubles around expected
+    static double ulp(double actual, double expected)
+    {
+        double spacing = std::nextafter(std::abs(expected), INFINITY) - std::abs(expected);
+        return std::abs(actual - expected) / spacing;
+    }
+
+    // multiply a chain of numbers so each multiply waits for the last one
+    template<size_t N>
+    static void multiply_time(std::vector<double> const& operands, size_t count)
+    {
+        using number = numbers::bigfloat<N>;
+
+        std::vector<number> values;
+        values.reserve(operands.size());
+        for (double operand : operands) { values.emplace_back(operand); }
+
+        number product(1.0);
+        double elapsed = seconds([&]() { for (size_t k = 0; k < count; ++k) { product = product * values[k % values.size()]; } });
+
+        // print the product so the loop can't be optimized away
+        std::cout << "  " << std::setw(4) << N * 64 << " bits: " << 1e9 * elapsed / count << " ns per multiply (product ~2^"
+            << product.exponent() << ")" << std::endl;
+    }
+
+    static bool bigfloat_accuracy(size_t samples)
+    {
+        using number = numbers::bigfloat<2>;
+
+        // random operands spread over many binades, checked against double arithmetic
+        std::mt19937_64 rng(c_seed);
+        std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+        std::uniform_int_distribution<int> exponent(-60, 60);
+        std::vector<double> operands(samples);
+        for (double& operand : operands) { operand = std::ldexp(mantissa(rng), exponent(rng)); }
+
+        double max_ulp = 0.0;
+        for (size_t k = 0; k + 1 < samples; ++k)
+        {
+            double a = operands[k];
+            double b = operands[k + 1];
+            number x(a);
+            number y(b);
+            max_ulp = std::max(max_ulp, ulp(static_cast<double>(x * y), a * b));
+            max_ulp = std::max(max_ulp, ulp(static_cast<double>(x + y), a + b));
+            max_ulp = std::max(max_ulp, ulp(static_cast<double>(x - y), a - b));
+        }
+
+        // decimals against the standard library's conversion
+        char const* decimals[] = { "0.1", "-0.743643887037158704752191506114774", "1.5e-20", "123456.789e3", "-2", "6.02214076e+23" };
+        double max_parse_ulp = 0.0;
+        for (char const* decimal : decimals)
+        {
+            std::optional<number> parsed = number::parse(decimal);
+            max_parse_ulp = std::max(max_parse_ulp, parsed ? ulp(static_cast<double>(*parsed), std::strtod(decimal, nullptr)) : INFINITY);
+        }
+
+        // 1 - 3 * 0.333...3 needs the full precision to come out as 10^-digits
+        using wide = numbers::bigfloat<32>;
+        std::string thirds = "0." + std::string(c_bigfloat_thirds, '3');
+        wide remainder = wide(1.0) - wide(3.0) * *wide::parse(thirds);
+        int64_t expected_exponent = static_cast<int64_t>(std::ceil(-c_bigfloat_thirds * std::log2(10.0)));
+        bool precise = std::abs(remainder.exponent() - expected_exponent) <= 2;
+
+        bool success = max_ulp <= c_bigfloat_max_ulp && max_parse_ulp <= c_bigfloat_max_ulp && precise;
+        std::cout << "bigfloat over " << samples << " operands: max error " << max_ulp << " ulp against double arithmetic, "
+            << max_parse_ulp << " ulp parsing decimals, 1 - 3 * 0.333... (" << c_bigfloat_thirds << " digits) ~2^"
+            << remainder.exponent() << " (expected ~2^" << expected_exponent << ")" << std::endl;
+
+        // the multiply is quadratic in the number of limbs, so fewer are timed at higher precision
+        multiply_time<1>(operands, samples);
+        multiply_time<2>(operands, samples);
+        multiply_time<4>(operands, samples / 2);
+        multiply_time<8>(operands, samples / 4);
+        multiply_time<16>(operands, samples / 8);
+        multiply_time<32>(operands, samples / 16);
+        return success;
+    }
+
+    // a square-ish grid of about samples points over the bounds
+    static std::vector<std::complex<double>> grid(double const (&bounds)[4], size_t samples)
+    {
+        double width = bounds[2] - bounds[0];
+        double height = bounds[3] - bounds[1];
+        size_t cols = static_cast<size_t>(std::sqrt(samples * width / height));
+        size_t rows = samples / cols;
+
+        std::vector<std::complex<double>> points;
+        points.reserve(cols * rows);
+        for (size_t j = 0; j < rows; ++j)
+        {
+            for (size_t i = 0; i < cols; ++i)
+            {
+                double x = bounds[0] + width * (i + 0.5) / cols;
+                double y = bounds[1] + height * (j + 0.5) / rows;
+                points.push_back({ x, y });
+            }
+        }
+        return points;
+    }
+
+    static void powertower(size_t samples)
+    {
+        std::vector<std::complex<double>> points = grid(c_powertower_bounds, samples);
+
+        std::vector<kernels::escape_t> expected(points.size());
+        double reference = seconds([&]() { for (size_t k = 0; k < points.size(); ++k) { expected[k] = reference_powertower(points[k]); } });
+
+        std::cout << "powertower over " << points.size() << " points in [" << c_powertower_bounds[0] << ", " << c_powertower_bounds[2]
+            << "] x [" << c_powertower_bounds[1] << ", " << c_powertower_bounds[3] << "] (std::complex: " << reference << " s)" << std::endl;
+
+        std::vector<kernels::escape_t> results(points.size());
+        for (simd::isa target : c_isas)
+        {
+            if (!simd::supported(target)) { continue; }
+            simd::select(target);
+
+            double elapsed = seconds([&]() { kernels::powertower<double>(points, results, c_powertower_cap, c_powertower_mag_cap, c_powertower_tolerance); });
+
+            // escape counts near the boundary are chaotic, so these are reported rather than required to be 0
+            size_t classified = 0;
+            size_t iterations = 0;
+            for (size_t k = 0; k < points.size(); ++k)
+            {
+                if (results[k].bounded != expected[k].bounded) { ++classified; }
+                else if (!results[k].bounded && results[k].iterations != expected[k].iterations) { ++iterations; }
+            }
+
+            std::cout << "  " << std::setw(6) << simd::name(target) << ": " << elapsed << " s (" << reference / elapsed << "x), "
+                << classified << " points classified differently, " << iterations << " escaped after a different iteration" << std::endl;
+        }
+    }
+
+    // the perturbation kernel for the target called directly, without going through kernels::perturbation
+    static kernels::perturbed_t perturbation_direct(simd::isa target, std::span<std::complex<double> const> offsets, std::span<kernels::escape_t> results, std::span<double> distances, kernels::orbit_t const& orbit)
+    {
+        kernels::series_t const series = {};
+        switch (target)
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: return kernels::avx512::perturbation(offsets.data(), results.data(), distances.data(), offsets.size(), orbit, series, c_perturbation_cap, 0.0);
+            case simd::isa::avx2:   return kernels::avx2  ::perturbation(offsets.data(), results.data(), distances.data(), offsets.size(), orbit, series, c_perturbation_cap, 0.0);
+#endif
+            default:                return kernels::scalar::perturbation(offsets.data(), results.data(), distances.data(), offsets.size(), orbit, series, c_perturbation_cap, 0.0);
+        }
+    }
+
+    // run a kernel over the points in batches the size generate hands to compute. the fastest of a few runs is
+    // reported since the differences being measured are small
+    template<typename Func>
+    static double batched(size_t count, Func func)
+    {
+        double fastest = INFINITY;
+        for (int run = 0; run < c_perturbation_runs; ++run)
+        {
+            fastest = std::min(fastest, seconds([&]()
+            {
+                for (size_t start = 0; start < count; start += c_perturbation_batch) { func(start, std::min(c_perturbation_batch, count - start)); }
+            }));
+        }
+        return fastest;
+    }
+
+    // the reference orbit in double precision is good enough to compare kernels that share it
+    static kernels::orbit_t reference_orbit(std::complex<double> center, std::vector<double>& re, std::vector<double>& im)
+    {
+        re.assign(1, 0.0);
+        im.assign(1, 0.0);
+        std::complex<double> z = 0.0;
+        for (int n = 0; n < c_perturbation_cap && std::norm(z) <= 4.0; ++n)
+        {
+            z = z * z + center;
+            re.push_back(z.real());
+            im.push_back(z.imag());
+        }
+        return { re.data(), im.data(), re.size() };
+    }
+
+    // a square grid of offsets within radius, and the same offsets in units of 2^c_perturbation_exponent
+    static void offset_grid(size_t samples, double radius, std::vector<std::complex<double>>& offsets, std::vector<std::complex<double>>& scaled)
+    {
+        size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(samples)));
+        offsets.clear();
+        scaled.clear();
+        offsets.reserve(side * side);
+        scaled.reserve(side * side);
+        for (size_t j = 0; j < side; ++j)
+        {
+            for (size_t i = 0; i < side; ++i)
+            {
+                double x = radius * (2.0 * (i + 0.5) / side - 1.0);
+                double y = radius * (2.0 * (j + 0.5) / side - 1.0);
+                offsets.push_back({ x, y });
+                scaled.push_back({ std::ldexp(x, static_cast<int>(-c_perturbation_exponent)), std::ldexp(y, static_cast<int>(-c_perturbation_exponent)) });
+            }
+        }
+    }
+
+    static bool perturbation(size_t samples)
+    {
+        std::vector<double> re, im;
+        std::complex<double> center(c_perturbation_center[0], c_perturbation_center[1]);
+        kernels::orbit_t orbit = reference_orbit(center, re, im);
+
+        std::vector<std::complex<double>> offsets, scaled;
+        offset_grid(samples, c_perturbation_radius, offsets, scaled);
+        size_t count = offsets.size();
+        kernels::series_t const series = {};
+
+        std::cout << std::defaultfloat << "perturbation over " << count << " offsets within " << c_perturbation_radius << " of (" << center.real() << ", "
+            << center.imag() << ") in batches of " << c_perturbation_batch << ", plain and in units of 2^" << c_perturbation_exponent << std::fixed << std::endl;
+
+        bool success = true;
+        std::vector<kernels::escape_t> direct(count), plain(count), deep(count);
+        std::vector<double> direct_distances(count), plain_distances(count), deep_distances(count);
+        for (simd::isa target : c_isas)
+        {
+            if (!simd::supported(target)) { continue; }
+            simd::select(target);
+
+            std::span<std::complex<double> const> all(offsets);
+            std::span<std::complex<double> const> all_scaled(scaled);
+            double direct_time = batched(count, [&](size_t start, size_t size)
+            {
+                perturbation_direct(target, all.subspan(start, size), std::span(direct).subspan(start, size), std::span(direct_distances).subspan(start, size), orbit);
+            });
+            double plain_time = batched(count, [&](size_t start, size_t size)
+            {
+                kernels::perturbation(all.subspan(start, size), 0, std::span(plain).subspan(start, size), orbit, series, c_perturbation_cap, 0.0, std::span(plain_distances).subspan(start, size));
+            });
+            double deep_time = batched(count, [&](size_t start, size_t size)
+            {
+                kernels::perturbation(all_scaled.subspan(start, size), c_perturbation_exponent, std::span(deep).subspan(start, size), orbit, series, c_perturbation_cap, 0.0, std::span(deep_distances).subspan(start, size));
+            });
+
+            // the scaled kernel only rescales by powers of two, so it has to agree exactly
+            size_t mismatched = 0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                bool same = deep[k].iterations == plain[k].iterations && deep[k].bounded == plain[k].bounded
+                    && direct[k].iterations == plain[k].iterations && direct[k].bounded == plain[k].bounded;
+                double distance = std::ldexp(deep_distances[k], static_cast<int>(c_perturbation_exponent));
+                bool close = (std::isnan(distance) && std::isnan(plain_distances[k])) || distance == plain_distances[k];
+                if (!same || !close) { ++mismatched; }
+            }
+            success = success && mismatched == 0;
+
+            std::cout << "  " << std::setw(6) << simd::name(target) << ": " << direct_time << " s direct, " << plain_time
+                << " s dispatched (" << 100.0 * (plain_time / direct_time - 1.0) << "% overhead), " << deep_time << " s with a separate exponent ("
+                << deep_time / plain_time << "x), " << mismatched << " points differ" << std::endl;
+        }
+        return success;
+    }
+
+    static bool series(size_t samples)
+    {
+        std::vector<double> re, im;
+        std::complex<double> center(c_series_center[0], c_series_center[1]);
+        kernels::orbit_t orbit = reference_orbit(center, re, im);
+
+        std::vector<std::complex<double>> offsets, scaled;
+        offset_grid(samples, c_series_radius, offsets, scaled);
+        size_t count = offsets.size();
+
+        // the radii of the series depend on the units the offsets are in, so each exponent gets its own
+        std::vector<double> series_re, series_im, scaled_re, scaled_im, series_radius, scaled_radius;
+        std::vector<int64_t> series_exponent, scaled_exponent;
+        kernels::series_t const none = {};
+        kernels::series_t const series = kernels::approximate(orbit, 0, c_perturbation_cap, series_re, series_im, series_exponent, series_radius);
+        kernels::series_t const scaled_series = kernels::approximate(orbit, c_perturbation_exponent, c_perturbation_cap, scaled_re, scaled_im, scaled_exponent, scaled_radius);
+
+        std::cout << std::defaultfloat << "series approximation over " << count << " offsets within " << c_series_radius << " of (" << center.real() << ", "
+            << center.imag() << "), plain and in units of 2^" << c_perturbation_exponent << std::fixed << std::endl;
+
+        bool success = true;
+        std::vector<kernels::escape_t> iterated(count), approximated(count), deep(count);
+        for (simd::isa target : c_isas)
+        {
+            if (!simd::supported(target)) { continue; }
+            simd::select(target);
+
+            std::span<std::complex<double> const> all(offsets);
+            std::span<std::complex<double> const> all_scaled(scaled);
+            uint64_t skipped = 0;
+            double iterated_time = batched(count, [&](size_t start, size_t size)
+            {
+                kernels::perturbation(all.subspan(start, size), 0, std::span(iterated).subspan(start, size), orbit, none, c_perturbation_cap, 0.0);
+            });
+            double approximated_time = batched(count, [&](size_t start, size_t size)
+            {
+                skipped += kernels::perturbation(all.subspan(start, size), 0, std::span(approximated).subspan(start, size), orbit, series, c_perturbation_cap, 0.0).approximated;
+            });
+            double deep_time = batched(count, [&](size_t start, size_t size)
+            {
+                kernels::perturbation(all_scaled.subspan(start, size), c_perturbation_exponent, std::span(deep).subspan(start, size), orbit, scaled_series, c_perturbation_cap, 0.0);
+            });
+
+            // skipping iterations rounds differently, so escapes that differ from iterating are reported rather than
+            // required to be 0. left of the tip the points are outside |c| <= 2, where perturbed escape counts mean
+            // nothing either way, so only offsets to the right are compared. scaling by powers of two is exact, so the
+            // scaled kernel has to agree with the plain one everywhere
+            size_t escaped = 0;
+            size_t mismatched = 0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                bool inside = offsets[k].real() > 0.0;
+                if (inside && (approximated[k].iterations != iterated[k].iterations || approximated[k].bounded != iterated[k].bounded)) { ++escaped; }
+                if (deep[k].iterations != approximated[k].iterations || deep[k].bounded != approximated[k].bounded) { ++mismatched; }
+            }
+            success = success && mismatched == 0;
+
+            std::cout << "  " << std::setw(6) << simd::name(target) << ": " << iterated_time << " s iterating, " << approximated_time
+                << " s skipping " << static_cast<double>(skipped) / (c_perturbation_runs * count) << " iterations per point (" << iterated_time / approximated_time
+                << "x), " << deep_time << " s with a separate exponent, " << escaped << " points right of the tip escape differently, " << mismatched
+                << " differ with a separate exponent" << std::endl;
+        }
+        return success;
+    }
+
+    // render the fields of a deep view through the mandelbrot generator, with the cap it chooses for the view
+    static bool deep_view(size_t samples)
+    {
+        int side = static_cast<int>(std::sqrt(static_cast<double>(samples)));
+        generators::coordinate_t scale = *generators::coordinate_t::parse(c_deep_scale);
+        generators::window_t window(*generators::coordinate_t::parse(c_deep_center[0]), *generators::coordinate_t::parse(c_deep_center[1]),
+            numbers::floatexp(scale.mantissa(), scale.exponent()), side, side, 1);
+
+        generators::config cfg(generators::types::mandelbrot, 0.0);
+        cfg.color = {};
+        cfg.diverging = {};
+        cfg.period_tolerance = c_mandelbrot_tolerance;
+        cfg.iterations = generators::choose_iterations(0, true, window);
+        cfg.perturb = true;
+        cfg.precision = generators::precision_t::f64;
+        std::unique_ptr<generators::generator> generator = generators::factory(cfg);
+
+        // the generator is relative, so it takes the offsets of the pixel centers from the center of the view
+        std::vector<std::complex<double>> offsets;
+        offsets.reserve(static_cast<size_t>(side) * side);
+        for (int j = 0; j < side; ++j)
+        {
+            for (int i = 0; i < side; ++i)
+            {
+                offsets.push_back({ (i + 0.5 - side / 2.0) * window.delta_x, (side / 2.0 - j - 0.5) * window.delta_y });
+            }
+        }
+
+        std::vector<generators::field_t> fields(offsets.size());
+        double elapsed = seconds([&]()
+        {
+            generator->prepare(window);
+            generator->compute(offsets, fields, {});
+        });
+
+        std::vector<int32_t> escapes;
+        for (generators::field_t const& field : fields)
+        {
+            if (field.bounded == 0) { escapes.push_back(field.value); }
+        }
+        std::sort(escapes.begin(), escapes.end());
+        size_t bounded = fields.size() - escapes.size();
+        size_t distinct = static_cast<size_t>(std::unique(escapes.begin(), escapes.end()) - escapes.begin());
+        bool success = bounded <= c_deep_max_bounded * fields.size() && distinct >= c_deep_min_distinct * fields.size();
+
+        std::cout << std::defaultfloat << "deep view " << c_deep_scale << " wide around (" << c_deep_center[0] << ", " << c_deep_center[1] << ") over "
+            << fields.size() << " samples" << std::fixed << std::endl;
+        std::cout << "  " << std::setw(6) << simd::name(simd::active()) << ": " << elapsed << " s with a cap of " << cfg.iterations << ", "
+            << bounded << " samples reach the cap, the others escape after " << distinct << " distinct iteration counts";
+        if (!escapes.empty()) { std::cout << " from " << escapes.front() << " to " << escapes[distinct - 1]; }
+        std::cout << std::endl;
+        return success;
+    }
+
+    // time a kernel iterating in double and in float on every instruction set. float rounds differently from double,
+    // so escapes that differ are reported, but the float kernels have to agree with each other
+    template<typename Kernel>
+    static bool compare_precisions(std::vector<std::complex<double>> const& points, Kernel kernel)
+    {
+        std::vector<kernels::escape_t> doubles(points.size());
+        std::vector<kernels::escape_t> floats(points.size());
+        std::vector<kernels::escape_t> first;
+
+        bool success = true;
+        for (simd::isa target : c_isas)
+        {
+            if (!simd::supported(target)) { continue; }
+            simd::select(target);
+
+            double double_time = seconds([&]() { kernel(double{}, doubles); });
+            double float_time = seconds([&]() { kernel(float{}, floats); });
+            if (first.empty()) { first = floats; }
+
+            size_t classified = 0;
+            size_t iterations = 0;
+            size_t mismatched = 0;
+            for (size_t k = 0; k < points.size(); ++k)
+            {
+                if (floats[k].bounded != doubles[k].bounded) { ++classified; }
+                else if (!floats[k].bounded && floats[k].iterations != doubles[k].iterations) { ++iterations; }
+                if (floats[k].iterations != first[k].iterations || floats[k].bounded != first[k].bounded) { ++mismatched; }
+            }
+            success = success && mismatched == 0;
+
+            std::cout << "    " << std::setw(6) << simd::name(target) << ": " << double_time << " s in double, " << float_time << " s in float ("
+                << double_time / float_time << "x), " << classified << " points classified differently, " << iterations
+                << " escaped after a different iteration, " << mismatched << " differ from " << simd::name(c_isas[0]) << std::endl;
+        }
+        return success;
+    }
+
+    static bool precision(size_t samples)
+    {
+        std::vector<std::complex<double>> mandelbrot_points = grid(c_mandelbrot_bounds, samples);
+        std::vector<std::complex<double>> powertower_points = grid(c_powertower_bounds, samples);
+
+        std::cout << "float against double over " << samples << " points" << std::endl;
+
+        std::cout << "  mandelbrot in [" << c_mandelbrot_bounds[0] << ", " << c_mandelbrot_bounds[2] << "] x [" << c_mandelbrot_bounds[1]
+            << ", " << c_mandelbrot_bounds[3] << "]" << std::endl;
+        bool success = compare_precisions(mandelbrot_points, [&](auto real, std::vector<kernels::escape_t>& results)
+        {
+            kernels::mandelbrot<decltype(real)>(mandelbrot_points, results, c_mandelbrot_cap, c_mandelbrot_tolerance);
+        });
+
+        std::cout << "  powertower in [" << c_powertower_bounds[0] << ", " << c_powertower_bounds[2] << "] x [" << c_powertower_bounds[1]
+            << ", " << c_powertower_bounds[3] << "]" << std::endl;
+        success = compare_precisions(powertower_points, [&](auto real, std::vector<kernels::escape_t>& results)
+        {
+            kernels::powertower<decltype(real)>(powertower_points, results, c_powertower_cap, c_powertower_mag_cap, c_powertower_tolerance);
+        }) && success;
+        return success;
+    }
+
+    int run(options::benchmark_opts const& opts)
+    {
+        simd::isa active = simd::active();
+
+        std::cout << std::fixed << std::setprecision(2);
+        bool success = exp_accuracy(opts.samples);
+        powertower(opts.samples);
+        success = bigfloat_accuracy(opts.samples) && success;
+        success = perturbation(opts.samples / 16) && success;
+        success = series(opts.samples / 16) && success;
+        success = precision(opts.samples) && success;
+
+        simd::select(active);
+        success = deep_view(opts.samples / 16) && success;
+        return success ? 0 : 1;
+    }
+
+}
\ No newline at end of file
@@ -15,9 +15,9 @@ namespace fractalgen::generators
         return static_cast<uint8_t>(std::clamp(x, 0.0, 255.0));
     }
 
-    static std::vector<newton::root> convert(std::vector<config::root> const& input)
+    static std::vector<root_t> convert(std::vector<config::root> const& input)
     {
-        std::vector<newton::root> roots;
+        std::vector<root_t> roots;
         roots.reserve(input.size());
         for (config::root const& r : input)
         {
@@ -26,18 +26,26 @@ namespace fractalgen::generators
         return roots;
     }
 
+    // the generator instantiated for the precision -- automatic (left unresolved when only shading) iterates in double
+    template<template<typename> class Generator, typename... Args>
+    static std::unique_ptr<generator> make(precision_t precision, Args const&... args)
+    {
+        if (precision == precision_t::f32) { return std::make_unique<Generator<float>>(args...); }
+        return std::make_unique<Generator<double>>(args...);
+    }
+
     std::unique_ptr<generator> factory(config const& cfg)
     {
         switch (cfg.type)
         {
             case types::mandelbrot:
-                return std::make_unique<mandelbrot>(cfg.phi, convert(cfg.color), convert(cfg.diverging));
+                return make<mandelbrot>(cfg.precision, cfg.phi, convert(cfg.color), convert(cfg.diverging), cfg.period_tolerance, cfg.iterations, cfg.perturb);
                 break;
             case types::powertower:
-                return std::make_unique<powertower>(cfg.phi, convert(cfg.color), convert(cfg.diverging));
+                return make<powertower>(cfg.precision, cfg.phi, convert(cfg.color), convert(cfg.diverging), cfg.period_tolerance);
                 break;
             case types::newton:
-                return std::make_unique<newton>(cfg.phi, convert(cfg.diverging), convert(cfg.roots));
+                return make<newton>(cfg.precision, cfg.phi, convert(cfg.diverging), convert(cfg.roots));
                 break;
             default: return nullptr;
         }
@@ -0,0 +1,102 @@
+#include "fractalgen/generators/field.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include <fstream>
+
+namespace fractalgen::generators
+{
+
+    static constexpr char c_magic[8] = { 'F', 'G', 'F', 'I', 'E', 'L', 'D', '2' };
+    static constexpr uint64_t c_alignment = 64;
+
+    // every member is naturally aligned so the header has no padding. values are stored in native byte order
+    struct header_t
+    {
+        char magic[8];
+        uint32_t type;
+        int32_t width;
+        int32_t height;
+        int32_t samples_sqrt;
+        uint32_t root_count;
+        int32_t iterations;         // the mandelbrot cap (0 for the other generators)
+        double bounds[4];
+        double phi;
+        double period_tolerance;
+        uint8_t color[3];
+        uint8_t diverging[3];
+        uint8_t reserved[2];
+        uint64_t offset;            // where the fields start
+    };
+
+    static_assert(sizeof(header_t) == 96);
+
+    static uint64_t fields_offset(size_t root_count)
+    {
+        uint64_t end = sizeof(header_t) + root_count * sizeof(config::root);
+        return (end + c_alignment - 1) / c_alignment * c_alignment;
+    }
+
+    bool save(std::string const& path, config const& cfg, window_t const& window, std::span<field_t const> fields)
+    {
+        header_t header = {};
+        std::memcpy(header.magic, c_magic, sizeof(c_magic));
+        header.type = static_cast<uint32_t>(cfg.type);
+        header.width = window.width;
+        header.height = window.height;
+        header.samples_sqrt = window.samples_sqrt;
+        header.root_count = static_cast<uint32_t>(cfg.roots.size());
+        header.iterations = cfg.iterations;
+        header.bounds[0] = window.bounds.min.x;
+        header.bounds[1] = window.bounds.min.y;
+        header.bounds[2] = window.bounds.max.x;
+        header.bounds[3] = window.bounds.max.y;
+        header.phi = cfg.phi;
+        header.period_tolerance = cfg.period_tolerance;
+        std::memcpy(header.color, cfg.color.data(), 3);
+        std::memcpy(header.diverging, cfg.diverging.data(), 3);
+        header.offset = fields_offset(cfg.roots.size());
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(cfg.roots.data()), cfg.roots.size() * sizeof(config::root));
+
+        // pad out to the aligned start of the fields
+        std::vector<char> padding(header.offset - sizeof(header) - cfg.roots.size() * sizeof(config::root), 0);
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<char const*>(fields.data()), fields.size_bytes());
+        return file.good();
+    }
+
+    std::optional<field_file> load(std::string const& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        header_t header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) { return std::nullopt; }
+        if (std::memcmp(header.magic, c_magic, sizeof(c_magic)) != 0) { return std::nullopt; }
+        if (header.width <= 0 || header.height <= 0 || header.samples_sqrt <= 0 || header.offset != fields_offset(header.root_count)) { return std::nullopt; }
+        if (header.type == static_cast<uint32_t>(types::mandelbrot) && header.iterations <= 0) { return std::nullopt; }
+
+        config cfg(static_cast<types>(header.type), header.phi);
+        cfg.period_tolerance = header.period_tolerance;
+        cfg.iterations = header.iterations;
+        std::memcpy(cfg.color.data(), header.color, 3);
+        std::memcpy(cfg.diverging.data(), header.diverging, 3);
+        cfg.roots.resize(header.root_count);
+        if (!file.read(reinterpret_cast<char*>(cfg.roots.data()), cfg.roots.size() * sizeof(config::root))) { return std::nullopt; }
+
+        // the bounds of a deep view are rounded, so the window is rebuilt around their center with the stored size
+        coordinate_t center_x((coordinate_t(header.bounds[0]) + coordinate_t(header.bounds[2])) * coordinate_t(0.5));
+        coordinate_t center_y((coordinate_t(header.bounds[1]) + coordinate_t(header.bounds[3])) * coordinate_t(0.5));
+        window_t window(center_x, center_y, numbers::floatexp(header.bounds[2] - header.bounds[0]), header.width, header.height, header.samples_sqrt);
+        field_file result = { cfg, window, {} };
+
+        size_t count = static_cast<size_t>(result.window.width) * result.window.height * result.window.samples();
+        result.fields.resize(count);
+        file.seekg(static_cast<std::streamoff>(header.offset));
+        if (!file.read(reinterpret_cast<char*>(result.fields.data()), count * sizeof(field_t))) { return std::nullopt; }
+        return result;
+    }
+
+}
\ No newline at end of file
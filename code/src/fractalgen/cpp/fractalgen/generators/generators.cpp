@@ -1,18 +1,41 @@
 #include "fractalgen/generators/generators.hpp"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <sstream>
 #include <thread>
 
+#include "fractalgen/threading/progress.hpp"
+#include "fractalgen/threading/work_stealing_queue.hpp"
+
 namespace fractalgen::generators
 {
 
-    static constexpr int c_thread_count = 16;
+    static constexpr int c_tile_size = 16;
+    static constexpr int c_subdivide_min = 8;               // rectangles narrower than this are colored directly
+    static constexpr int c_progressive_step = 16;           // spacing of the coarsest progressive grid (a power of two)
+    static constexpr std::chrono::milliseconds c_refresh_interval(500);
+    static constexpr int64_t c_min_spacing_exponent = -960;   // smaller pixel spacings are kept in units of 2^exponent
+    static constexpr double c_single_steps = 4096;          // float has to resolve a pixel into at least this many steps
+
+    static constexpr int c_mandelbrot_cap = 500;
+    static constexpr int64_t c_deep_spacing_exponent = -16;  // the period tolerance shrinks for pixel spacings below 2^this
+    static constexpr int64_t c_deep_extent_exponent = -42;   // views narrower than 2^this are past the resolution of double
+    static constexpr int c_iterations_per_bit = 1024;       // extra mandelbrot iterations per bit of depth
+
+    static constexpr int c_powertower_cap = 200;
+    static constexpr double c_powertower_mag_cap = 50;
 
-    static constexpr int c_supersample_sqrt = 4;
-    static constexpr double c_inset = 1.0 / (c_supersample_sqrt + 1);
+    static constexpr int c_newton_cap = 100;
+    static constexpr double c_newton_eps = 0.000000001;
+    static constexpr double c_newton_max_radius = 1e150;
 
     static int now_seconds()
     {
@@ -20,225 +43,911 @@ namespace fractalgen::generators
         return std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
     }
 
-    static void color_pixels(generator const& gen, window_t const& window, int min_j, int max_j, std::vector<rgb_t>& pixels, std::vector<bool>& status)
+    // split the window into square tiles and deal out contiguous runs of tiles to each worker
+    static void partition(window_t const& window, threading::work_stealing_queue<tile_t>& tiles)
+    {
+        int cols = (window.width + c_tile_size - 1) / c_tile_size;
+        int rows = (window.height + c_tile_size - 1) / c_tile_size;
+        int count = cols * rows;
+        size_t workers = tiles.workers();
+        for (int t = 0; t < count; ++t)
+        {
+            int min_i = (t % cols) * c_tile_size;
+            int min_j = (t / cols) * c_tile_size;
+            tile_t tile = { min_i, min_j, std::min(min_i + c_tile_size, window.width), std::min(min_j + c_tile_size, window.height) };
+            tiles.push(static_cast<size_t>(t) * workers / count, tile);
+        }
+    }
+
+    static rgb_t average(std::span<rgb_t const> colors)
+    {
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        for (rgb_t const& color : colors)
+        {
+            r += color.r;
+            g += color.g;
+            b += color.b;
+        }
+        int count = static_cast<int>(colors.size());
+        return { r / count, g / count, b / count };
+    }
+
+    // what the passes of generate write for each pixel -- distances and fields are empty unless they were requested
+    struct image_t
+    {
+        std::vector<rgb_t>& pixels;
+        std::span<double> distances;
+        std::span<field_t> fields;                          // the same number of fields for every pixel
+    };
+
+    // scratch space a worker reuses for every batch of pixels it colors
+    struct scratch_t
+    {
+        std::vector<size_t> indices;
+        std::vector<std::complex<double>> samples;
+        std::vector<field_t> fields;
+        std::vector<rgb_t> colors;
+        std::vector<double> distances;
+    };
+
+    // color the pixels at scratch.indices with window.samples() samples each. the supersamples of the whole batch are
+    // gathered so the generator is only invoked once. if requested, each pixel's fields are stored (repeated if the
+    // image stores more fields per pixel than the window samples) along with the smallest distance estimate among its
+    // samples
+    static void color_pixels(generator const& gen, window_t const& window, image_t const& image, scratch_t& scratch)
+    {
+        size_t count = static_cast<size_t>(window.samples());
+        scratch.samples.resize(scratch.indices.size() * count);
+        scratch.fields.resize(scratch.indices.size() * count);
+        scratch.colors.resize(scratch.indices.size() * count);
+        scratch.distances.resize(image.distances.empty() ? 0 : scratch.samples.size());
+
+        for (size_t k = 0; k < scratch.indices.size(); ++k)
+        {
+            int i = static_cast<int>(scratch.indices[k] % window.width);
+            int j = static_cast<int>(scratch.indices[k] / window.width);
+            gen.supersample(window, i, j, std::span(scratch.samples).subspan(k * count, count));
+        }
+
+        gen.compute(scratch.samples, scratch.fields, scratch.distances);            // virtual function call
+        for (size_t s = 0; s < scratch.fields.size(); ++s)
+        {
+            scratch.colors[s] = gen.shade(scratch.fields[s]);
+        }
+
+        size_t stride = image.fields.size() / image.pixels.size();
+        for (size_t k = 0; k < scratch.indices.size(); ++k)
+        {
+            size_t p = scratch.indices[k];
+            image.pixels[p] = average(std::span(scratch.colors).subspan(k * count, count));
+            if (!image.distances.empty())
+            {
+                auto samples = std::span(scratch.distances).subspan(k * count, count);
+                image.distances[p] = *std::min_element(samples.begin(), samples.end());
+            }
+            for (size_t s = 0; s < stride; ++s)
+            {
+                image.fields[p * stride + s] = scratch.fields[k * count + s * count / stride];
+            }
+        }
+    }
+
+    // color the pixels of each tile the worker pops. when refine is non-empty only the pixels it flags are colored
+    static void color_tiles(generator const& gen, window_t const& window, std::span<uint8_t const> refine, threading::work_stealing_queue<tile_t>& tiles, size_t worker, image_t const& image, threading::progress& progress)
+    {
+        scratch_t scratch;
+        while (std::optional<tile_t> tile = tiles.pop(worker))
+        {
+            scratch.indices.clear();
+            for (int j = tile->min_j; j < tile->max_j; ++j)
+            {
+                for (int i = tile->min_i; i < tile->max_i; ++i)
+                {
+                    size_t p = static_cast<size_t>(j) * window.width + i;
+                    if (refine.empty() || refine[p] != 0) { scratch.indices.push_back(p); }
+                }
+            }
+
+            color_pixels(gen, window, image, scratch);
+            progress.add(worker, scratch.indices.size());
+        }
+    }
+
+    static bool same(rgb_t const& lhs, rgb_t const& rhs)
+    {
+        return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+    }
+
+    static bool same(field_t const& lhs, field_t const& rhs)
+    {
+        return lhs.value == rhs.value && lhs.bounded == rhs.bounded;
+    }
+
+    // append the pixels on the border of the rectangle
+    static void border(window_t const& window, tile_t const& rect, std::vector<size_t>& indices)
+    {
+        int last_i = rect.max_i - 1;
+        int last_j = rect.max_j - 1;
+        for (int i = rect.min_i; i <= last_i; ++i)
+        {
+            indices.push_back(static_cast<size_t>(rect.min_j) * window.width + i);
+            if (last_j != rect.min_j) { indices.push_back(static_cast<size_t>(last_j) * window.width + i); }
+        }
+        for (int j = rect.min_j + 1; j < last_j; ++j)
+        {
+            indices.push_back(static_cast<size_t>(j) * window.width + rect.min_i);
+            if (last_i != rect.min_i) { indices.push_back(static_cast<size_t>(j) * window.width + last_i); }
+        }
+    }
+
+    // where a point of the complex plane falls in the window, in (fractional) pixels
+    static stfd::vec2 pixel_position(window_t const& window, std::complex<double> const& point)
+    {
+        double x = static_cast<double>(coordinate_t(point.real()) - window.center_x);
+        double y = static_cast<double>(coordinate_t(point.imag()) - window.center_y);
+        int shift = static_cast<int>(-window.exponent);
+        return stfd::vec2(0.5 * window.width + std::ldexp(x / window.delta_x, shift), 0.5 * window.height - std::ldexp(y / window.delta_y, shift));
+    }
+
+    // mariani-silver subdivision of a rectangle whose border has already been colored: fill its interior if the border
+    // is a single color, color the interior directly if the rectangle is small, and otherwise color a line through
+    // the middle and push the two halves (which each share the line as a border). returns the number of filled pixels.
+    // filled pixels have no boundary nearby so their distance estimates are infinite. when fields are kept the border
+    // has to agree on them instead of just the color, since pixels of one color may still differ in their fields --
+    // the regions of equal field are the ones the generator's connectedness argument is about, so the interior has the
+    // fields of the border too. a rectangle around nest (see generator::nested_around) is never filled
+    static size_t subdivide(generator const& gen, window_t const& window, tile_t const& rect, std::optional<stfd::vec2> const& nest, threading::work_stealing_queue<tile_t>& rects, size_t worker, image_t const& image, threading::progress& progress, scratch_t& scratch)
+    {
+        std::vector<rgb_t>& pixels = image.pixels;
+        int width = rect.max_i - rect.min_i;
+        int height = rect.max_j - rect.min_j;
+        if (width <= 2 || height <= 2) { return 0; }                                // no interior
+        tile_t interior = { rect.min_i + 1, rect.min_j + 1, rect.max_i - 1, rect.max_j - 1 };
+
+        scratch.indices.clear();
+        border(window, rect, scratch.indices);
+        size_t first = scratch.indices.front();
+        rgb_t color = pixels[first];
+        size_t stride = image.fields.size() / pixels.size();
+        auto fields_of = [&](size_t p) { return image.fields.begin() + p * stride; };
+        bool uniform = (stride != 0)
+            ? std::all_of(scratch.indices.begin(), scratch.indices.end(), [&](size_t p) { return std::equal(fields_of(p), fields_of(p) + stride, fields_of(first), [](field_t const& lhs, field_t const& rhs) { return same(lhs, rhs); }); })
+            : std::all_of(scratch.indices.begin(), scratch.indices.end(), [&](size_t p) { return same(pixels[p], color); });
+        bool surrounds = nest && nest->x > rect.min_i - 1 && nest->x < rect.max_i && nest->y > rect.min_j - 1 && nest->y < rect.max_j;
+        if (uniform && !surrounds)
+        {
+            int count = interior.max_i - interior.min_i;
+            for (int j = interior.min_j; j < interior.max_j; ++j)
+            {
+                size_t row = static_cast<size_t>(j) * window.width + interior.min_i;
+                std::fill_n(pixels.begin() + row, count, color);
+                if (!image.distances.empty()) { std::fill_n(image.distances.begin() + row, count, std::numeric_limits<double>::infinity()); }
+                for (size_t p = row; p < row + count && stride != 0; ++p)
+                {
+                    std::copy_n(fields_of(first), stride, fields_of(p));
+                }
+            }
+            progress.add(worker, interior.size());
+            return interior.size();
+        }
+
+        scratch.indices.clear();
+        if (width < c_subdivide_min || height < c_subdivide_min)
+        {
+            for (int j = interior.min_j; j < interior.max_j; ++j)
+            {
+                for (int i = interior.min_i; i < interior.max_i; ++i) { scratch.indices.push_back(static_cast<size_t>(j) * window.width + i); }
+            }
+            color_pixels(gen, window, image, scratch);
+            progress.add(worker, scratch.indices.size());
+            return 0;
+        }
+
+        // split across the longer side
+        if (width >= height)
+        {
+            int mid = (rect.min_i + rect.max_i) / 2;
+            for (int j = interior.min_j; j < interior.max_j; ++j) { scratch.indices.push_back(static_cast<size_t>(j) * window.width + mid); }
+            color_pixels(gen, window, image, scratch);
+            rects.push(worker, { rect.min_i, rect.min_j, mid + 1, rect.max_j });
+            rects.push(worker, { mid, rect.min_j, rect.max_i, rect.max_j });
+        }
+        else
+        {
+            int mid = (rect.min_j + rect.max_j) / 2;
+            for (int i = interior.min_i; i < interior.max_i; ++i) { scratch.indices.push_back(static_cast<size_t>(mid) * window.width + i); }
+            color_pixels(gen, window, image, scratch);
+            rects.push(worker, { rect.min_i, rect.min_j, rect.max_i, mid + 1 });
+            rects.push(worker, { rect.min_i, mid, rect.max_i, rect.max_j });
+        }
+        progress.add(worker, scratch.indices.size());
+        return 0;
+    }
+
+    // subdivide rectangles until every rectangle has been processed. workers push the halves of the rectangles they
+    // split, so an empty queue only means the work is done once nothing is pending
+    static void subdivide_rects(generator const& gen, window_t const& window, std::optional<stfd::vec2> const& nest, threading::work_stealing_queue<tile_t>& rects, size_t worker, image_t const& image, threading::progress& progress, std::atomic<size_t>& filled)
     {
-        for (int j = min_j; j < max_j; ++j)
+        scratch_t scratch;
+        size_t count = 0;
+        while (rects.pending() != 0)
+        {
+            if (std::optional<tile_t> rect = rects.pop(worker))
+            {
+                count += subdivide(gen, window, *rect, nest, rects, worker, image, progress, scratch);
+                rects.finish();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        filled.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static bool differs(window_t const& window, rgb_t const& lhs, rgb_t const& rhs)
+    {
+        return std::abs(lhs.r - rhs.r) > window.threshold
+            || std::abs(lhs.g - rhs.g) > window.threshold
+            || std::abs(lhs.b - rhs.b) > window.threshold;
+    }
+
+    // flag every pixel whose color differs from one of its 8 neighbors by more than threshold in some channel
+    static std::vector<uint8_t> find_edges(window_t const& window, std::vector<rgb_t> const& pixels)
+    {
+        std::vector<uint8_t> edges(pixels.size(), 0);
+        for (int j = 0; j < window.height; ++j)
         {
-            int offset = j * window.width;
             for (int i = 0; i < window.width; ++i)
             {
-                pixels[offset + i] = gen.color_pixel(window, i, j);
-                status[offset + i] = true;
+                rgb_t const& pixel = pixels[j * window.width + i];
+                for (int dj = -1; dj <= 1; ++dj)
+                {
+                    for (int di = -1; di <= 1; ++di)
+                    {
+                        int ni = i + di;
+                        int nj = j + dj;
+                        if (ni < 0 || ni >= window.width || nj < 0 || nj >= window.height) { continue; }
+                        if (differs(window, pixel, pixels[nj * window.width + ni])) { edges[j * window.width + i] = 1; }
+                    }
+                }
             }
         }
+        return edges;
     }
 
-    static void color_pixels_ptr(generators::generator const* gen, window_t const& window, int min_j, int max_j, std::vector<rgb_t>* pixels, std::vector<bool>* status)
+    // flag the unvisited neighbors of each refined pixel whose supersampled color differs from its preview color
+    static std::vector<uint8_t> grow(window_t const& window, std::vector<uint8_t> const& refined, std::vector<rgb_t> const& preview, std::vector<rgb_t> const& pixels, std::vector<uint8_t>& visited)
     {
-        color_pixels(*gen, window, min_j, max_j, *pixels, *status);
+        std::vector<uint8_t> next(pixels.size(), 0);
+        for (int j = 0; j < window.height; ++j)
+        {
+            for (int i = 0; i < window.width; ++i)
+            {
+                size_t p = static_cast<size_t>(j) * window.width + i;
+                if (refined[p] == 0 || !differs(window, preview[p], pixels[p])) { continue; }
+                for (int dj = -1; dj <= 1; ++dj)
+                {
+                    for (int di = -1; di <= 1; ++di)
+                    {
+                        int ni = i + di;
+                        int nj = j + dj;
+                        if (ni < 0 || ni >= window.width || nj < 0 || nj >= window.height) { continue; }
+                        size_t q = static_cast<size_t>(nj) * window.width + ni;
+                        if (visited[q] == 0) { visited[q] = 1; next[q] = 1; }
+                    }
+                }
+            }
+        }
+        return next;
     }
 
-    window_t::window_t(stfd::aabb2 const& _bounds, int _width)
+    static void print_progress(std::string_view name, double progress, time_t start)
+    {
+        std::ostringstream stream;
+
+        int bar_width = 50;
+
+        {
+            stream << "\rRendering " << name;
+        }
+
+        // write progress bar
+        {
+            stream << " [";
+            int pos = bar_width * progress;
+            for (int i = 0; i < bar_width; ++i)
+            {
+                if (i <= pos) { stream << "#"; }
+                else { stream << " "; }
+            }
+            stream << "] ";
+        }
+
+        // add percentage
+        {
+            stream << std::fixed << std::setprecision(0) << (progress * 100.0) << "%";
+        }
+
+        // add duration and estimated time remaining
+        {
+            time_t elapsed = now_seconds() - start;
+            stream << " -- " << elapsed << " seconds elapsed";
+            if (0.0 < progress && progress < 1.0)
+            {
+                stream << ", ~" << elapsed * (1.0 - progress) / progress << " seconds remaining";
+            }
+            stream << "          ";                                               // clear leftovers from a longer line
+        }
+
+        std::cout << stream.str();
+        std::cout.flush();
+    }
+
+    window_t::window_t(stfd::aabb2 const& _bounds, int _width, int _samples_sqrt)
         : bounds(_bounds)
         , width(_width)
         , height(static_cast<int>(width * (bounds.diagonal().y / bounds.diagonal().x)))
         , delta_x(bounds.diagonal().x / width)
         , delta_y(bounds.diagonal().y / height)
-        , inset_x(c_inset * delta_x)
-        , inset_y(c_inset * delta_y)
+        , samples_sqrt(_samples_sqrt)
+        , inset_x(delta_x / (samples_sqrt + 1))
+        , inset_y(delta_y / (samples_sqrt + 1))
+        , center_x((coordinate_t(bounds.min.x) + coordinate_t(bounds.max.x)) * coordinate_t(0.5))
+        , center_y((coordinate_t(bounds.min.y) + coordinate_t(bounds.max.y)) * coordinate_t(0.5))
     {}
 
-    generator::generator(double phi) : m_phi(phi) {}
+    window_t::window_t(coordinate_t const& _center_x, coordinate_t const& _center_y, numbers::floatexp const& _scale, int _width, int _height, int _samples_sqrt)
+        : bounds(stfd::vec2(static_cast<double>(_center_x) - static_cast<double>(_scale) / 2, static_cast<double>(_center_y) - static_cast<double>(_scale) * _height / (2.0 * _width)),
+                 stfd::vec2(static_cast<double>(_center_x) + static_cast<double>(_scale) / 2, static_cast<double>(_center_y) + static_cast<double>(_scale) * _height / (2.0 * _width)))
+        , width(_width)
+        , height(_height)
+        , samples_sqrt(_samples_sqrt)
+        , center_x(_center_x)
+        , center_y(_center_y)
+    {
+        numbers::floatexp spacing(_scale.mantissa / width, _scale.exponent);
+        exponent = (spacing.exponent < c_min_spacing_exponent) ? spacing.exponent : 0;
+        delta_x = std::ldexp(spacing.mantissa, static_cast<int>(spacing.exponent - exponent));
+        delta_y = delta_x;
+        inset_x = delta_x / (samples_sqrt + 1);
+        inset_y = delta_y / (samples_sqrt + 1);
+    }
+
+    // rounding a sample to float moves it by up to half of float's spacing at its magnitude, and every iteration
+    // rounds z (which moves at magnitudes around 1 however small the view is) by about as much. the margin keeps both
+    // far below a pixel
+    precision_t choose_precision(precision_t requested, window_t const& window)
+    {
+        if (requested != precision_t::automatic) { return requested; }
+        if (window.exponent != 0) { return precision_t::f64; }
+
+        double magnitude = std::max({ std::abs(window.bounds.min.x), std::abs(window.bounds.max.x), std::abs(window.bounds.min.y), std::abs(window.bounds.max.y) });
+        double resolution = FLT_EPSILON * std::max(magnitude, 1.0);
+        return (std::min(window.delta_x, window.delta_y) >= c_single_steps * resolution) ? precision_t::f32 : precision_t::f64;
+    }
 
-    std::vector<rgb_t> generator::generate(window_t const& window) const
+    // the exterior of a deeper view lies closer to the set, where orbits take longer to escape. escape counts in the
+    // seahorse valley grow about linearly with the number of bits the view is narrower than double resolves. the depth
+    // is taken from the width of the view rather than the pixel spacing, so a framing shades the same at any size
+    int choose_iterations(int requested, bool perturb, window_t const& window)
     {
-        std::vector<bool> status(window.width * window.height, false);
+        if (requested > 0) { return requested; }
+        if (!perturb) { return c_mandelbrot_cap; }
 
-        time_t start = now_seconds();                                             // get start time
+        int64_t extent = std::ilogb(window.delta_x * window.width) + window.exponent;
+        int64_t depth = std::max<int64_t>(0, c_deep_extent_exponent - extent);
+        return static_cast<int>(std::min<int64_t>(c_mandelbrot_cap + c_iterations_per_bit * depth, std::numeric_limits<int>::max()));
+    }
 
-        std::vector<rgb_t> pixels;
-        pixels.resize(window.width * window.height);
+    // rotate by complement of phi since z is in the image space and we want the preimage
+    generator::generator(double phi)
+        : m_phi(phi), m_rotation(mobius_t::rotation(stfd::vec3(0, 1, 0), stfd::constants::two_pi - phi))
+    {}
+
+    // the same view with one sample per pixel. it is copied rather than rebuilt from the bounds, which are rounded for
+    // deep views
+    static window_t single_sample(window_t const& window)
+    {
+        window_t single = window;
+        single.samples_sqrt = 1;
+        single.inset_x = single.delta_x / 2;
+        single.inset_y = single.delta_y / 2;
+        return single;
+    }
+
+    // flag the pixels within window.distance pixel diagonals of a boundary. a pixel inside a region the estimate does
+    // not cover (distance 0) is only flagged when a neighbor outside it is near a boundary. relative generators measure
+    // distances in the window's units
+    static std::vector<uint8_t> near_boundary(window_t const& window, std::vector<double> const& distances, bool relative)
+    {
+        double limit = window.distance * std::ldexp(std::hypot(window.delta_x, window.delta_y), relative ? 0 : static_cast<int>(window.exponent));
+        auto near = [limit](double d) { return !(d >= limit); };                   // a nan estimate counts as near
+
+        std::vector<uint8_t> refine(distances.size(), 0);
+        for (int j = 0; j < window.height; ++j)
+        {
+            for (int i = 0; i < window.width; ++i)
+            {
+                size_t p = static_cast<size_t>(j) * window.width + i;
+                if (distances[p] != 0.0)
+                {
+                    refine[p] = near(distances[p]) ? 1 : 0;
+                    continue;
+                }
+
+                for (int dj = -1; dj <= 1 && refine[p] == 0; ++dj)
+                {
+                    for (int di = -1; di <= 1; ++di)
+                    {
+                        int ni = i + di;
+                        int nj = j + dj;
+                        if (ni < 0 || nj < 0 || ni >= window.width || nj >= window.height) { continue; }
+
+                        double d = distances[static_cast<size_t>(nj) * window.width + ni];
+                        if (d != 0.0 && near(d)) { refine[p] = 1; break; }
+                    }
+                }
+            }
+        }
+        return refine;
+    }
 
-        // kick off threads
-        std::vector<std::thread> threads;
-        for (int t = 0; t < c_thread_count; ++t)
+    // flag the pixels on the grid with the given spacing that are not on the next coarser grid (which the previous level
+    // already colored)
+    static std::vector<uint8_t> level(window_t const& window, int step)
+    {
+        std::vector<uint8_t> refine(static_cast<size_t>(window.width) * window.height, 0);
+        int coarser = 2 * step;
+        for (int j = 0; j < window.height; j += step)
         {
-            int min = (int)(t/(double)c_thread_count * window.height);
-            int max = (int)((t+1)/(double)c_thread_count * window.height);
-            threads.push_back(std::thread(color_pixels_ptr, this, window, min, max, &pixels, &status));
+            for (int i = 0; i < window.width; i += step)
+            {
+                bool colored = step < c_progressive_step && i % coarser == 0 && j % coarser == 0;
+                if (!colored) { refine[static_cast<size_t>(j) * window.width + i] = 1; }
+            }
         }
+        return refine;
+    }
 
-        while (true)
+    // stretch the pixels on the grid with the given spacing over the blocks they are the top left corner of
+    static std::vector<rgb_t> blocks(window_t const& window, std::vector<rgb_t> const& pixels, int step)
+    {
+        std::vector<rgb_t> image(pixels.size());
+        for (int j = 0; j < window.height; ++j)
         {
-            size_t completed = 0;
-            std::for_each(status.begin(), status.end(), [&completed](bool status) { if (status) { ++completed; } });
-            double progress = static_cast<double>(completed) / (window.width * window.height);
+            size_t row = static_cast<size_t>(j - j % step) * window.width;
+            for (int i = 0; i < window.width; ++i)
+            {
+                image[static_cast<size_t>(j) * window.width + i] = pixels[row + (i - i % step)];
+            }
+        }
+        return image;
+    }
 
-            std::ostringstream stream;
+    std::vector<rgb_t> generator::generate(window_t const& window, threading::thread_pool& pool, preview_fn const& preview, std::vector<field_t>* fields) const
+    {
+        time_t start = now_seconds();                                             // get start time
+        prepare(window);
+        reset_stats();
 
-            int bar_width = 50;
+        std::vector<rgb_t> pixels;
+        pixels.resize(window.width * window.height);
 
+        // adaptive passes add the pixels they supersample to the total as they go
+        size_t total = static_cast<size_t>(window.width) * window.height;
+        threading::progress progress(pool.size());
+
+        // distance estimates of the single sample pass, when adaptive mode uses them
+        std::vector<double> distances;
+
+        if (fields != nullptr) { fields->assign(pixels.size() * window.samples(), {}); }
+
+        std::atomic<size_t> filled = 0;
+        auto render = [&](window_t const& pass, std::span<uint8_t const> refine)
+        {
+            image_t image = { pixels, distances, (fields != nullptr) ? std::span<field_t>(*fields) : std::span<field_t>() };
+            threading::work_stealing_queue<tile_t> tiles(pool.size());
+            // rotating the sphere can bring infinity into view and turn the bands around it into rings
+            bool subdivided = pass.subdivide && refine.empty() && simply_connected() && m_phi == 0.0;
+            std::optional<stfd::vec2> nest;
+            if (std::optional<std::complex<double>> point = nested_around()) { nest = pixel_position(pass, *point); }
+            if (subdivided)
             {
-                stream << "\rRendering " << name();
+                // color the border of the whole image and then subdivide it
+                tile_t whole = { 0, 0, pass.width, pass.height };
+                scratch_t scratch;
+                border(pass, whole, scratch.indices);
+                color_pixels(*this, pass, image, scratch);
+                progress.add(0, scratch.indices.size());
+                tiles.push(0, whole);
             }
-
-            // write progress bar
+            else
             {
-                stream << " [";
-                int pos = bar_width * progress;
-                for (int i = 0; i < bar_width; ++i)
-                {
-                    if (i <= pos) { stream << "#"; }
-                    else { stream << " "; }
-                }
-                stream << "] ";
+                partition(pass, tiles);
             }
 
-            // add percentage
+            // kick off a worker on each thread in the pool
+            std::vector<std::future<void>> workers;
+            for (size_t w = 0; w < pool.size(); ++w)
             {
-                stream << std::fixed << std::setprecision(0) << (progress * 100.0) << "%";
+                if (subdivided) { workers.push_back(pool.submit([&, w]() { subdivide_rects(*this, pass, nest, tiles, w, image, progress, filled); })); }
+                else { workers.push_back(pool.submit([&, w]() { color_tiles(*this, pass, refine, tiles, w, image, progress); })); }
             }
 
-            // add duration
+            // redraw the progress bar until each worker is done -- wait_for returns as soon as a worker finishes
+            for (std::future<void>& worker : workers)
             {
-                time_t current = now_seconds();
-                stream << " -- " << current - start << " seconds elapsed";
+                while (worker.wait_for(c_refresh_interval) != std::future_status::ready)
+                {
+                    print_progress(name(), static_cast<double>(progress.completed()) / total, start);
+                }
+                worker.get();
             }
+        };
 
-            std::cout << stream.str();
-            std::cout.flush();
+        // the pass that colors every pixel, optionally coarse to fine
+        auto cover = [&](window_t const& pass)
+        {
+            if (!pass.progressive) { render(pass, {}); return; }
 
-            if (completed == window.width * window.height)
+            for (int step = c_progressive_step; step >= 1; step /= 2)
             {
-                break;
+                render(pass, level(pass, step));
+                if (preview && step > 1) { preview(blocks(pass, pixels, step)); }
             }
-            else
+        };
+
+        size_t supersampled = pixels.size();
+        // rotating the sphere stretches distances by a varying factor, so the estimates are only used without it
+        bool estimated = window.adaptive && estimates_distance() && m_phi == 0.0;
+        if (estimated)
+        {
+            // color each pixel with a single sample and then supersample only the pixels near a boundary
+            window_t single = single_sample(window);
+            distances.resize(pixels.size());
+            cover(single);
+            std::vector<uint8_t> refine = near_boundary(window, distances, relative());
+            distances.clear();
+
+            supersampled = static_cast<size_t>(std::count(refine.begin(), refine.end(), 1));
+            total += supersampled;
+            render(window, refine);
+        }
+        else if (window.adaptive)
+        {
+            // color each pixel with a single sample and then supersample only the pixels on an edge
+            window_t single = single_sample(window);
+            cover(single);
+            std::vector<rgb_t> first = pixels;
+            std::vector<uint8_t> refine = find_edges(window, pixels);
+            std::vector<uint8_t> visited = refine;
+
+            // a supersampled pixel that came out differently from its single sample has detail the first pass missed,
+            // so its neighbors are supersampled as well until no more detail turns up
+            supersampled = 0;
+            while (true)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                size_t count = static_cast<size_t>(std::count(refine.begin(), refine.end(), 1));
+                if (count == 0) { break; }
+                supersampled += count;
+                total += count;
+                render(window, refine);
+                refine = grow(window, refine, first, pixels, visited);
             }
         }
+        else
+        {
+            cover(window);
+        }
+
+        print_progress(name(), 1.0, start);
         std::cout << std::endl;
+        print_stats(std::cout);
+
+        if (filled != 0)
+        {
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << "Subdivision filled " << filled << " of " << pixels.size() << " pixels (" << 100.0 * filled / pixels.size() << "%)" << std::endl;
+        }
+        if (window.adaptive)
+        {
+            size_t samples = pixels.size() + supersampled * window.samples();
+            double fewer = static_cast<double>(pixels.size() * window.samples()) / samples;
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << "Supersampled " << supersampled << " of " << pixels.size() << " pixels (" << 100.0 * supersampled / pixels.size()
+                << "%) -- " << samples << " samples, " << fewer << "x fewer than supersampling every pixel" << std::endl;
+        }
+
+        return pixels;
+    }
+
+    std::vector<rgb_t> generator::recolor(window_t const& window, std::span<field_t const> fields, threading::thread_pool& pool) const
+    {
+        std::vector<rgb_t> pixels(static_cast<size_t>(window.width) * window.height);
+        size_t stride = fields.size() / pixels.size();
+
+        // shade contiguous runs of rows on each thread in the pool
+        std::vector<std::future<void>> workers;
+        for (size_t w = 0; w < pool.size(); ++w)
+        {
+            size_t begin = w * pixels.size() / pool.size();
+            size_t end = (w + 1) * pixels.size() / pool.size();
+            workers.push_back(pool.submit([&, begin, end]()
+            {
+                std::vector<rgb_t> colors(stride);
+                for (size_t p = begin; p < end; ++p)
+                {
+                    for (size_t s = 0; s < stride; ++s) { colors[s] = shade(fields[p * stride + s]); }
+                    pixels[p] = average(colors);
+                }
+            }));
+        }
+        for (std::future<void>& worker : workers) { worker.get(); }
 
-        // join threads
-        for (unsigned int t = 0; t < c_thread_count; ++t) { threads[t].join(); }
         return pixels;
     }
 
     rgb_t generator::color_pixel(window_t const& window, int i, int j) const
     {
-        int r = 0;
-        int g = 0;
-        int b = 0;
-        double intial_x = window.bounds.min.x + i * window.delta_x + window.inset_x;
-        double intial_y = window.bounds.max.y - j * window.delta_y + window.inset_y;
-        for (size_t u = 0; u < c_supersample_sqrt; ++u)
+        std::vector<std::complex<double>> samples(window.samples());
+        supersample(window, i, j, samples);
+
+        std::vector<rgb_t> colors(window.samples());
+        color_complex_nums(samples, colors);
+        return average(colors);
+    }
+
+    void generator::supersample(window_t const& window, int i, int j, std::span<std::complex<double>> samples) const
+    {
+        // offsets are measured from the center, which is half the view away from the top left corner
+        double origin_x = window.bounds.min.x;
+        double origin_y = window.bounds.max.y;
+        if (relative())
+        {
+            origin_x = -0.5 * window.width * window.delta_x;
+            origin_y = 0.5 * window.height * window.delta_y;
+        }
+
+        // relative generators take offsets in the window's units, absolute points are always plain doubles
+        int exponent = relative() ? 0 : static_cast<int>(window.exponent);
+        double delta_x = std::ldexp(window.delta_x, exponent);
+        double delta_y = std::ldexp(window.delta_y, exponent);
+        double inset_x = std::ldexp(window.inset_x, exponent);
+        double inset_y = std::ldexp(window.inset_y, exponent);
+
+        double intial_x = origin_x + i * delta_x + inset_x;
+        double intial_y = origin_y - j * delta_y + inset_y;
+        for (int u = 0; u < window.samples_sqrt; ++u)
         {
-            for (size_t v = 0; v < c_supersample_sqrt; ++v)
+            for (int v = 0; v < window.samples_sqrt; ++v)
             {
-                double x = intial_x + u * window.inset_x;
-                double y = intial_y - v * window.inset_y;
+                double x = intial_x + u * inset_x;
+                double y = intial_y - v * inset_y;
                 std::complex<double> z(x, y);
-                if (m_phi != stfd::constants::zero)
+                if (m_phi != stfd::constants::zero && !relative())
                 {
-                    stfd::vec3 reimann_point = to_riemann_sphere(z);                // map to riemann sphere
-                    // rotate by complement of phi since z is in the image space and we want the preimage
-                    double complement = stfd::constants::two_pi - m_phi;
-                    stfd::vec3 rotated = stf::math::rotate(reimann_point, stfd::vec3(0, 1, 0), complement);
-                    z = to_complex(rotated);                                        // map back to the complex plane
+                    z = m_rotation(z);                                              // rotate the riemann sphere
                 }
-                rgb_t color = color_complex_num(z);                         // virtual function call
-                r += color.r;
-                g += color.g;
-                b += color.b;
+                samples[u * window.samples_sqrt + v] = z;
             }
         }
-        r /= (c_supersample_sqrt * c_supersample_sqrt);
-        g /= (c_supersample_sqrt * c_supersample_sqrt);
-        b /= (c_supersample_sqrt * c_supersample_sqrt);
-        return { r, g, b };
     }
 
-    stfd::vec3 generator::to_riemann_sphere(std::complex<double> const& num)
+    rgb_t generator::color_complex_num(std::complex<double> const& num) const
     {
-        double x = num.real();
-        double y = num.imag();
+        rgb_t color;
+        color_complex_nums({ &num, 1 }, { &color, 1 });
+        return color;
+    }
 
-        double denom = 1 + x * x + y * y;
-        stfd::vec3 vec;
-        vec.x = 2 * x / denom;
-        vec.y = 2 * y / denom;
-        vec.z = (-1 + x * x + y * y) / denom;
-        return vec;
+    void generator::color_complex_nums(std::span<std::complex<double> const> nums, std::span<rgb_t> colors) const
+    {
+        std::vector<field_t> fields(nums.size());
+        compute(nums, fields, {});                                                  // virtual function call
+        for (size_t k = 0; k < nums.size(); ++k)
+        {
+            colors[k] = shade(fields[k]);
+        }
     }
 
-    std::complex<double> generator::to_complex(stfd::vec3 const& vec)
+    // the fields of escape time generators are their kernel's results
+    static void convert(std::span<kernels::escape_t const> escapes, std::span<field_t> fields)
     {
-        if (vec.x == 0.0 && vec.y == 0.0 && vec.z == 1.0)
+        for (size_t k = 0; k < escapes.size(); ++k)
         {
-            return std::complex<double>(DBL_MAX, DBL_MAX);
+            fields[k] = { escapes[k].iterations, escapes[k].bounded ? 1 : 0 };
         }
+    }
 
-        double a = vec.x / (1.0 - vec.z);
-        double b = vec.y / (1.0 - vec.z);
-        return std::complex<double>(a, b);
+    void iteration_stats::reset()
+    {
+        performed = 0;
+        skipped = 0;
+        saved = 0;
+        glitched = 0;
+        overrun = 0;
+        approximated = 0;
+        samples = 0;
     }
 
-    mandelbrot::mandelbrot(double phi, rgb_t color, rgb_t diverging)
-        : generator(phi), m_color(color), m_diverging()
+    void iteration_stats::accumulate(std::span<kernels::escape_t const> escapes, int cap, uint64_t batch_approximated)
     {
-        m_diverging.x = static_cast<double>(diverging.r) / 255;
-        m_diverging.y = static_cast<double>(diverging.g) / 255;
-        m_diverging.z = static_cast<double>(diverging.b) / 255;
+        uint64_t batch_performed = 0;
+        uint64_t batch_skipped = 0;
+        uint64_t batch_saved = 0;
+        for (kernels::escape_t const& escape : escapes)
+        {
+            batch_performed += escape.iterations;
+            if (escape.bounded)
+            {
+                if (escape.iterations == 0) { batch_skipped += cap; }
+                else { batch_saved += cap - escape.iterations; }
+            }
+        }
+
+        // accumulate once per batch to keep contention on the counters down
+        performed.fetch_add(batch_performed - batch_approximated, std::memory_order_relaxed);
+        skipped.fetch_add(batch_skipped, std::memory_order_relaxed);
+        saved.fetch_add(batch_saved, std::memory_order_relaxed);
+        approximated.fetch_add(batch_approximated, std::memory_order_relaxed);
+        samples.fetch_add(escapes.size(), std::memory_order_relaxed);
     }
 
-    rgb_t mandelbrot::color_complex_num(std::complex<double> const& num) const
+    void iteration_stats::print(std::ostream& stream) const
     {
-        // quick check to decrease computation time
-        if (abs(num) < 0.2) { return m_color; }
-        else if (num.real() < 0)
+        uint64_t total_performed = performed;
+        uint64_t total_skipped = skipped;
+        uint64_t total_saved = saved;
+        uint64_t total_approximated = approximated;
+        double total = static_cast<double>(total_performed + total_skipped + total_saved + total_approximated);
+        auto percent = [total](uint64_t count) { return (total == 0.0) ? 0.0 : 100.0 * count / total; };
+
+        stream << std::fixed << std::setprecision(1);
+        stream << "Iterations: " << total_performed << " performed, "
+            << total_skipped << " skipped by interior tests (" << percent(total_skipped) << "%), "
+            << total_saved << " saved by periodicity checking (" << percent(total_saved) << "%)" << std::endl;
+        if (glitched != 0 || overrun != 0)
         {
-            if (abs(num) < 0.6) { return m_color; }
+            stream << "Rebased perturbed points onto the start of the reference orbit " << glitched << " times after a glitch and "
+                << overrun << " times at the end of the reference" << std::endl;
         }
-        std::complex<double> z(0.0, 0.0);                                   // start the 0-orbit
-        int cap = 500;                                                      // set an iteration cap
-        int i;
-        for (i = 0; i < cap && abs(z) <= 2; i++)                            // iterate 0 on z_n+1 = z_n^2 + num
+        if (total_approximated != 0)
         {
-            z = pow(z, 2) + num;
+            stream << "Series approximation skipped " << total_approximated << " iterations (" << percent(total_approximated) << "%), "
+                << static_cast<double>(total_approximated) / samples << " per sample" << std::endl;
         }
-        if (abs(z) <= 2) { return m_color; }                                // if orbit has not diverged to infinity, return the background color
+    }
+
+    // rotating the riemann sphere moves points by far more than a deep zoom's offsets, so perturbation is only used
+    // for the plain complex plane
+    template<typename T>
+    mandelbrot<T>::mandelbrot(double phi, rgb_t color, rgb_t diverging, double period_tolerance, int cap, bool perturb)
+        : generator(phi), m_color(color), m_diverging(), m_period_tolerance(period_tolerance), m_cap(cap), m_perturb(perturb && phi == 0.0)
+    {
+        m_diverging.x = static_cast<double>(diverging.r) / 255;
+        m_diverging.y = static_cast<double>(diverging.g) / 255;
+        m_diverging.z = static_cast<double>(diverging.b) / 255;
+    }
+
+    template<typename T>
+    rgb_t mandelbrot<T>::shade(field_t const& field) const
+    {
+        if (field.bounded != 0) { return m_color; }                         // if orbit has not diverged to infinity, return the background color
         else                                                                // otherwise, compute the scaled color
         {
-            double scale = static_cast<double>(i) / cap;
+            double scale = static_cast<double>(field.value) / m_cap;
             stfd::vec3 rgb = m_diverging + scale * (stfd::vec3(1) - m_diverging);
             stfi::vec3 bytes = (255.0 * rgb).as<int>();
             return { bytes.x, bytes.y, bytes.z };
         }
     }
 
-    powertower::powertower(double phi, rgb_t color, rgb_t diverging)
-        : generator(phi), m_color(color), m_diverging()
+    template<typename T>
+    void mandelbrot<T>::compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> distances) const
+    {
+        // iterate 0 on z_n+1 = z_n^2 + num with the vectorized kernel
+        std::vector<kernels::escape_t> escapes(nums.size());
+        uint64_t approximated = 0;
+        if (m_perturb)
+        {
+            kernels::orbit_t orbit = { m_orbit_re.data(), m_orbit_im.data(), m_orbit_re.size() };
+            kernels::series_t series = { m_series_re.data(), m_series_im.data(), m_series_exponent.data(), m_series_radius.data(), m_series_re.size() };
+            kernels::perturbed_t counts = kernels::perturbation(nums, m_exponent, escapes, orbit, series, m_cap, m_tolerance, distances);
+            m_stats.glitched.fetch_add(counts.glitched, std::memory_order_relaxed);
+            m_stats.overrun.fetch_add(counts.overrun, std::memory_order_relaxed);
+            approximated = counts.approximated;
+        }
+        else
+        {
+            kernels::mandelbrot<T>(nums, escapes, m_cap, m_period_tolerance, distances);
+        }
+
+        convert(escapes, fields);
+        m_stats.accumulate(escapes, m_cap, approximated);
+    }
+
+    // iterate the window center at the given precision (until it escapes or reaches the cap), rounding each value
+    // to double
+    template<size_t N>
+    static void reference_orbit(window_t const& window, int cap, std::vector<double>& re, std::vector<double>& im)
+    {
+        using number = numbers::bigfloat<N>;
+
+        number const cx(window.center_x);
+        number const cy(window.center_y);
+        number x;
+        number y;
+        re.assign(1, 0.0);
+        im.assign(1, 0.0);
+        for (int n = 0; n < cap; ++n)
+        {
+            number xy = x * y;
+            x = (x * x - y * y) + cx;
+            y = (xy + xy) + cy;
+
+            double real = static_cast<double>(x);
+            double imag = static_cast<double>(y);
+            re.push_back(real);
+            im.push_back(imag);
+            if (real * real + imag * imag > 4.0) { break; }
+        }
+    }
+
+    // the offsets only need to be accurate relative to the pixel spacing, so the reference is computed with a 64 bit
+    // margin below it. the precision is rounded up to a power of two limbs to keep the number of instantiations down.
+    // the period tolerance shrinks with the spacing of deep views, where orbits of neighboring pixels are otherwise
+    // within it of returning long before they escape. once it is below the resolution of z the comparison would only
+    // see the rounded reference orbit return, so periodicity checking is turned off
+    template<typename T>
+    void mandelbrot<T>::prepare(window_t const& window) const
+    {
+        if (!m_perturb) { return; }
+
+        m_exponent = window.exponent;
+        int64_t spacing = std::ilogb(std::min(window.delta_x, window.delta_y)) + window.exponent;
+        int64_t shift = std::clamp<int64_t>(spacing - c_deep_spacing_exponent, -64, 0);
+        m_tolerance = std::ldexp(m_period_tolerance, static_cast<int>(shift));
+        if (m_tolerance < DBL_EPSILON) { m_tolerance = 0.0; }
+        size_t bits = static_cast<size_t>(std::max<int64_t>(0, -spacing)) + 64;
+        if (bits <= 128) { reference_orbit<2>(window, m_cap, m_orbit_re, m_orbit_im); }
+        else if (bits <= 256) { reference_orbit<4>(window, m_cap, m_orbit_re, m_orbit_im); }
+        else if (bits <= 512) { reference_orbit<8>(window, m_cap, m_orbit_re, m_orbit_im); }
+        else if (bits <= 1024) { reference_orbit<16>(window, m_cap, m_orbit_re, m_orbit_im); }
+        else { reference_orbit<32>(window, m_cap, m_orbit_re, m_orbit_im); }
+        kernels::approximate({ m_orbit_re.data(), m_orbit_im.data(), m_orbit_re.size() }, m_exponent, m_cap, m_series_re, m_series_im, m_series_exponent, m_series_radius);
+    }
+
+    template<typename T>
+    void mandelbrot<T>::reset_stats() const
+    {
+        m_stats.reset();
+    }
+
+    template<typename T>
+    void mandelbrot<T>::print_stats(std::ostream& stream) const
+    {
+        m_stats.print(stream);
+    }
+
+    template<typename T>
+    powertower<T>::powertower(double phi, rgb_t color, rgb_t diverging, double period_tolerance)
+        : generator(phi), m_color(color), m_diverging(), m_period_tolerance(period_tolerance)
     {
         m_diverging.x = static_cast<double>(diverging.r) / 255;
         m_diverging.y = static_cast<double>(diverging.g) / 255;
         m_diverging.z = static_cast<double>(diverging.b) / 255;
     }
 
-    rgb_t powertower::color_complex_num(std::complex<double> const& num) const
+    template<typename T>
+    rgb_t powertower<T>::shade(field_t const& field) const
     {
-        std::complex<double> z = num;                                       // start the input
-        std::complex<double> prev = z;                                      // set up previous value
-        int iter_cap = 200;                                                 // set an iteration cap
-        double mag_cap = 50;                                                // set up a magnitude cap
-        int i;
-        for (i = 0; i < iter_cap && abs(z) < mag_cap; i++)                  // iterate 0 on z_n+1 = num^z_n
-        {
-            z = pow(num, z);                                                // exponentiate
-        }
-        if (abs(z) < mag_cap) { return m_color; }                           // if orbit has not diverged to infinity, return the background color
+        if (field.bounded != 0) { return m_color; }                         // if orbit has not diverged to infinity, return the background color
         else                                                                // otherwise, compute the scaled color
         {
-            double div = iter_cap/(double)i;
+            double div = c_powertower_cap/(double)field.value;
             div = 1000;
             stfd::vec3 rgb = m_diverging + (1 / div) * (stfd::vec3(1) - m_diverging);
             stfi::vec3 bytes = (255.0 * rgb).as<int>();
@@ -246,85 +955,96 @@ namespace fractalgen::generators
         }
     }
 
-    std::complex<double> newton::function::evaluate(std::complex<double> const& z) const
+    template<typename T>
+    void powertower<T>::compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> /* distances */) const
     {
-        return evaluate(roots.begin(), roots.end(), z);
+        // iterate 0 on z_n+1 = num^z_n with the vectorized kernel
+        std::vector<kernels::escape_t> escapes(nums.size());
+        kernels::powertower<T>(nums, escapes, c_powertower_cap, c_powertower_mag_cap, m_period_tolerance);
+
+        convert(escapes, fields);
+        m_stats.accumulate(escapes, c_powertower_cap);
     }
 
-    std::complex<double> newton::function::evaluate_deriv(std::complex<double> const& z) const
+    template<typename T>
+    void powertower<T>::reset_stats() const
     {
-        return evaluate_deriv(roots.begin(), roots.end(), z);
+        m_stats.reset();
     }
 
-    std::complex<double> newton::function::evaluate(iter begin, iter end, std::complex<double> const& z)
+    template<typename T>
+    void powertower<T>::print_stats(std::ostream& stream) const
     {
-        std::complex<double> res = 1.0;
-        for (auto it = begin; it != end; ++it)
-        {
-            res *= (z - it->z);
-        }
-        return res;
+        m_stats.print(stream);
     }
 
-    std::complex<double> newton::function::evaluate_deriv(iter begin, iter end, std::complex<double> const& z)
+    // compute the radius of a disk around each root in which newton's method is guaranteed to converge to that root
+    static std::vector<double> capture_radii(std::vector<root_t> const& roots)
     {
-        auto diff = end - begin;
-        if (diff == 1)
+        // writing w = z - r and d for the distance from r to the nearest other root, the newton step satisfies
+        // |N(z) - r| <= |w| * t / (1 - t) where t = |w| (n - 1) / (d - |w|). so newton's method contracts towards r
+        // while |w| < d / (2n - 1)
+        size_t n = roots.size();
+        std::vector<double> radii;
+        radii.reserve(n);
+        for (size_t k = 0; k < n; ++k)
         {
-            return 1.0;
-        }
-        else
-        {
-            return evaluate(begin + 1, end, z) + (z - begin->z) * evaluate_deriv(begin + 1, end, z);
+            double nearest = std::numeric_limits<double>::infinity();
+            for (size_t l = 0; l < n; ++l)
+            {
+                if (l != k) { nearest = std::min(nearest, std::abs(roots[k].z - roots[l].z)); }
+            }
+
+            // every root is at least given the radius that is used to identify converged points. a lone root captures
+            // everything (newton's method on a linear function converges in one step)
+            double radius = nearest / (2.0 * n - 1.0);
+            radii.push_back(std::clamp(radius, c_newton_eps, c_newton_max_radius));
         }
+        return radii;
     }
 
-    std::complex<double> newton::newtons_method(std::complex<double> const& initial, double eps) const
+    template<typename T>
+    newton<T>::newton(double phi, rgb_t diverging, std::vector<root_t> const& roots)
+        : generator(phi),
+        m_diverging(diverging),
+        m_roots(roots)
     {
-        std::complex<double> prev;
-        int cap = 100;
-        int i;
-        std::complex<double> z = initial;
-        for (i = 0; i < cap; i++) {
-            prev = z;
-            z = z - m_function.evaluate(z) / m_function.evaluate_deriv(z);
-            if (abs(z - prev) <= eps) { return z; }
+        std::vector<double> radii = capture_radii(roots);
+        for (size_t k = 0; k < roots.size(); ++k)
+        {
+            m_re.push_back(roots[k].z.real());
+            m_im.push_back(roots[k].z.imag());
+            m_radius_sq.push_back(radii[k] * radii[k]);
         }
-        return z;
     }
 
-    // method to return the index of the zeros array within eps (a small value)
-    int newton::index(std::complex<double> const& z, double eps) const
+    template<typename T>
+    void newton<T>::compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> /* distances */) const
     {
-        std::vector<root> const& roots = m_function.roots;
-        auto found = std::find_if(roots.begin(), roots.end(), [&](root const& r)
-        {
-            return std::abs(z - r.z) <= eps;
-        });
+        // run newton's method on every number with the vectorized kernel
+        std::vector<int> found(nums.size());
+        kernels::roots_t roots = { m_re.data(), m_im.data(), m_radius_sq.data(), m_roots.size() };
+        kernels::newton<T>(nums, found, roots, c_newton_cap, c_newton_eps);
 
-        if (found != roots.end())
+        for (size_t k = 0; k < nums.size(); ++k)
         {
-            return found - roots.begin();
-        }
-        else
-        {
-            return -1;
+            fields[k] = { found[k], (found[k] == -1) ? 0 : 1 };
         }
     }
 
-    newton::newton(double phi, rgb_t diverging, std::vector<root> const& roots)
-        : generator(phi),
-        m_diverging(diverging),
-        m_function({ roots })
-    {}
-
-    rgb_t newton::color_complex_num(std::complex<double> const& num) const
+    template<typename T>
+    rgb_t newton<T>::shade(field_t const& field) const
     {
-        double eps = 0.000000001;
-        std::complex<double> zero = newtons_method(num, eps);
-        int i = index(zero, eps);
-        if (i == -1) { return m_diverging; }
-        else { return m_function.roots[i].color; }
+        // a field from a file may refer to a root this generator doesn't have
+        bool found = field.bounded != 0 && 0 <= field.value && static_cast<size_t>(field.value) < m_roots.size();
+        return found ? m_roots[field.value].color : m_diverging;
     }
 
+    template class mandelbrot<float>;
+    template class mandelbrot<double>;
+    template class powertower<float>;
+    template class powertower<double>;
+    template class newton<float>;
+    template class newton<double>;
+
 }
\ No newline at end of file
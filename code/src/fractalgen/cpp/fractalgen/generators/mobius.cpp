@@ -0,0 +1,24 @@
+#include "fractalgen/generators/mobius.hpp"
+
+#include <cmath>
+
+namespace fractalgen::generators
+{
+
+    mobius_t mobius_t::rotation(stfd::vec3 const& axis, double angle)
+    {
+        // the rotation by angle about the unit axis n corresponds to the su(2) matrix with
+        // a = cos(angle/2) + i n_z sin(angle/2) and b = sin(angle/2) (-n_y + i n_x)
+        double length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+        double s = std::sin(angle / 2) / length;
+        double cos_half = std::cos(angle / 2);
+
+        mobius_t transform;
+        transform.a = { cos_half, axis.z * s };
+        transform.b = { -axis.y * s, axis.x * s };
+        transform.c = -std::conj(transform.b);
+        transform.d = std::conj(transform.a);
+        return transform;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "fractalgen/kernels/targets.hpp"
+
+#include "fractalgen/simd/avx2.hpp"
+#include "fractalgen/kernels/mandelbrot.hpp"
+#include "fractalgen/kernels/newton.hpp"
+#include "fractalgen/kernels/perturbation.hpp"
+#include "fractalgen/kernels/powertower.hpp"
+
+namespace fractalgen::kernels::avx2
+{
+
+    template<typename T>
+    void mandelbrot(std::complex<double> const* points, escape_t* results, double* distances, size_t count, int cap, double tolerance)
+    {
+        if (distances != nullptr) { impl::mandelbrot<simd::avx2::vec<T>, true>(points, results, distances, count, cap, tolerance); }
+        else { impl::mandelbrot<simd::avx2::vec<T>, false>(points, results, distances, count, cap, tolerance); }
+    }
+
+    template void mandelbrot<float>(std::complex<double> const*, escape_t*, double*, size_t, int, double);
+    template void mandelbrot<double>(std::complex<double> const*, escape_t*, double*, size_t, int, double);
+
+    perturbed_t perturbation(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int cap, double tolerance)
+    {
+        if (distances != nullptr) { return impl::perturbation<simd::avx2::f64, true>(offsets, results, distances, count, orbit, series, cap, tolerance); }
+        return impl::perturbation<simd::avx2::f64, false>(offsets, results, distances, count, orbit, series, cap, tolerance);
+    }
+
+    perturbed_t perturbation_scaled(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int64_t exponent, int cap, double tolerance)
+    {
+        if (distances != nullptr) { return impl::perturbation_scaled<simd::avx2::f64, true>(offsets, results, distances, count, orbit, series, exponent, cap, tolerance); }
+        return impl::perturbation_scaled<simd::avx2::f64, false>(offsets, results, distances, count, orbit, series, exponent, cap, tolerance);
+    }
+
+    template<typename T>
+    void powertower(std::complex<double> const* points, std::complex<double> const* logs, size_t const* positions, escape_t* results, size_t count, int cap, double magnitude, double tolerance)
+    {
+        impl::powertower<simd::avx2::vec<T>>(points, logs, positions, results, count, cap, magnitude, tolerance);
+    }
+
+    template void powertower<float>(std::complex<double> const*, std::complex<double> const*, size_t const*, escape_t*, size_t, int, double, double);
+    template void powertower<double>(std::complex<double> const*, std::complex<double> const*, size_t const*, escape_t*, size_t, int, double, double);
+
+    void exp(std::complex<double> const* points, std::complex<double>* results, size_t count)
+    {
+        impl::exp<simd::avx2::f64>(points, results, count);
+    }
+
+    template<typename T>
+    void newton(std::complex<double> const* points, int* results, size_t count, roots_t const& roots, int cap, double eps)
+    {
+        impl::newton<simd::avx2::vec<T>>(points, results, count, roots, cap, eps);
+    }
+
+    template void newton<float>(std::complex<double> const*, int*, size_t, roots_t const&, int, double);
+    template void newton<double>(std::complex<double> const*, int*, size_t, roots_t const&, int, double);
+
+}
\ No newline at end of file
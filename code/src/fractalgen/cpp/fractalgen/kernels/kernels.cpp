@@ -0,0 +1,193 @@
+#include "fractalgen/kernels/kernels.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+#include <algorithm>
+
+#include "fractalgen/kernels/targets.hpp"
+#include "fractalgen/numbers/floatexp.hpp"
+#include "fractalgen/simd/isa.hpp"
+
+namespace fractalgen::kernels
+{
+
+    static constexpr double c_series_tolerance = DBL_EPSILON / 2;       // relative error the series approximation may add
+
+    static constexpr int c_shell_thron_iterations = 32;
+    static constexpr double c_shell_thron_eps = 1e-9;
+
+    template<typename T>
+    void mandelbrot(std::span<std::complex<double> const> points, std::span<escape_t> results, int cap, double tolerance, std::span<double> distances)
+    {
+        switch (simd::active())
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: avx512::mandelbrot<T>(points.data(), results.data(), distances.empty() ? nullptr : distances.data(), points.size(), cap, tolerance); break;
+            case simd::isa::avx2:   avx2  ::mandelbrot<T>(points.data(), results.data(), distances.empty() ? nullptr : distances.data(), points.size(), cap, tolerance); break;
+#endif
+            default:                scalar::mandelbrot<T>(points.data(), results.data(), distances.empty() ? nullptr : distances.data(), points.size(), cap, tolerance); break;
+        }
+    }
+
+    template void mandelbrot<float>(std::span<std::complex<double> const>, std::span<escape_t>, int, double, std::span<double>);
+    template void mandelbrot<double>(std::span<std::complex<double> const>, std::span<escape_t>, int, double, std::span<double>);
+
+    perturbed_t perturbation(std::span<std::complex<double> const> offsets, int64_t exponent, std::span<escape_t> results, orbit_t const& orbit, series_t const& series, int cap, double tolerance, std::span<double> distances)
+    {
+        double* out = distances.empty() ? nullptr : distances.data();
+        if (exponent != 0)
+        {
+            switch (simd::active())
+            {
+#if defined(FRACTALGEN_SIMD_X86)
+                case simd::isa::avx512: return avx512::perturbation_scaled(offsets.data(), results.data(), out, offsets.size(), orbit, series, exponent, cap, tolerance);
+                case simd::isa::avx2:   return avx2  ::perturbation_scaled(offsets.data(), results.data(), out, offsets.size(), orbit, series, exponent, cap, tolerance);
+#endif
+                default:                return scalar::perturbation_scaled(offsets.data(), results.data(), out, offsets.size(), orbit, series, exponent, cap, tolerance);
+            }
+        }
+
+        switch (simd::active())
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: return avx512::perturbation(offsets.data(), results.data(), out, offsets.size(), orbit, series, cap, tolerance);
+            case simd::isa::avx2:   return avx2  ::perturbation(offsets.data(), results.data(), out, offsets.size(), orbit, series, cap, tolerance);
+#endif
+            default:                return scalar::perturbation(offsets.data(), results.data(), out, offsets.size(), orbit, series, cap, tolerance);
+        }
+    }
+
+    // the coefficients follow coefficient_s+1 = 2 Z_s coefficient_s + 1 from coefficient_0 = 0. step s drops the d_s^2
+    // term, which is below a rounding error of 2 Z_s d_s while |coefficient_s dc| < eps |2 Z_s|, and entry s is valid
+    // where every step before it is. the coefficients are kept as a mantissa and an exponent to keep them in range
+    series_t approximate(orbit_t const& orbit, int64_t exponent, int cap, std::vector<double>& re, std::vector<double>& im, std::vector<int64_t>& exponents, std::vector<double>& radii)
+    {
+        re.clear();
+        im.clear();
+        exponents.clear();
+        radii.clear();
+
+        // the kernel goes on to read Z_s+1, and stops at the cap
+        size_t length = std::min(orbit.length - 1, static_cast<size_t>(cap));
+        std::complex<double> coefficient = 0.0;
+        int64_t scale = 0;
+        double radius = INFINITY;
+        for (size_t s = 0; s < length; ++s)
+        {
+            re.push_back(coefficient.real());
+            im.push_back(coefficient.imag());
+            exponents.push_back(scale);
+            radii.push_back(radius);
+
+            // d_1 = dc exactly, so the first step never limits the radius
+            std::complex<double> twice(2.0 * orbit.re[s], 2.0 * orbit.im[s]);
+            if (s > 0)
+            {
+                double limit = c_series_tolerance * std::abs(twice) / std::abs(coefficient);
+                radius = std::min(radius, static_cast<double>(numbers::floatexp(limit, -scale - exponent)));
+            }
+
+            coefficient = twice * coefficient + std::ldexp(1.0, static_cast<int>(-scale));
+            int shift;
+            std::frexp(std::max(std::abs(coefficient.real()), std::abs(coefficient.imag())), &shift);
+            coefficient = { std::ldexp(coefficient.real(), -shift), std::ldexp(coefficient.imag(), -shift) };
+            scale += shift;
+        }
+        return { re.data(), im.data(), exponents.data(), radii.data(), re.size() };
+    }
+
+    // the tower converges exactly when z -> exp(z * log_num) has an attracting fixed point z*. its multiplier
+    // lambda = z* * log_num solves lambda = log_num * exp(lambda) and the fixed point is attracting when |lambda| < 1
+    // (the shell-thron region). lambda * exp(-lambda) is one-to-one on the unit disk, so any solution newton's method
+    // finds in the disk is the fixed point's multiplier
+    static bool shell_thron(std::complex<double> const& log_num)
+    {
+        std::complex<double> lambda = log_num;
+        for (int k = 0; k < c_shell_thron_iterations; ++k)
+        {
+            std::complex<double> e = log_num * std::exp(lambda);
+            std::complex<double> step = (lambda - e) / (1.0 - e);
+            lambda -= step;
+            if (std::norm(step) < c_shell_thron_eps * c_shell_thron_eps) { break; }
+        }
+
+        // stay strictly inside the disk -- on the boundary the fixed point is neutral and the tower might not converge
+        double residual = std::abs(lambda - log_num * std::exp(lambda));
+        return residual < c_shell_thron_eps && std::abs(lambda) < 1.0 - c_shell_thron_eps;
+    }
+
+    // the points are classified here with std::complex, which must not be compiled into the kernels (see
+    // fractalgen/kernels/targets.hpp), and only the rest are passed on with their logs
+    template<typename T>
+    void powertower(std::span<std::complex<double> const> points, std::span<escape_t> results, int cap, double magnitude, double tolerance)
+    {
+        std::vector<std::complex<double>> nums;
+        std::vector<std::complex<double>> logs;
+        std::vector<size_t> positions;
+        nums.reserve(points.size());
+        logs.reserve(points.size());
+        positions.reserve(points.size());
+
+        double magnitude_sq = magnitude * magnitude;
+        for (size_t k = 0; k < points.size(); ++k)
+        {
+            std::complex<double> num = points[k];
+
+            // the tower 0, 0^0, 0^0^0, ... alternates between 0 and 1 so it is bounded (and log(0) is undefined)
+            if (num == 0.0) { results[k] = { 0, true }; continue; }
+
+            // z_0 = num is already outside the magnitude cap
+            if (!(std::norm(num) < magnitude_sq)) { results[k] = { 0, false }; continue; }
+
+            // adding +0.0 turns a -0.0 imaginary part into +0.0 so negative reals always get the principal log
+            std::complex<double> log_num = std::log(std::complex<double>(num.real(), num.imag() + 0.0));
+            if (shell_thron(log_num)) { results[k] = { 0, true }; continue; }
+
+            nums.push_back(num);
+            logs.push_back(log_num);
+            positions.push_back(k);
+        }
+
+        switch (simd::active())
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: avx512::powertower<T>(nums.data(), logs.data(), positions.data(), results.data(), nums.size(), cap, magnitude, tolerance); break;
+            case simd::isa::avx2:   avx2  ::powertower<T>(nums.data(), logs.data(), positions.data(), results.data(), nums.size(), cap, magnitude, tolerance); break;
+#endif
+            default:                scalar::powertower<T>(nums.data(), logs.data(), positions.data(), results.data(), nums.size(), cap, magnitude, tolerance); break;
+        }
+    }
+
+    template void powertower<float>(std::span<std::complex<double> const>, std::span<escape_t>, int, double, double);
+    template void powertower<double>(std::span<std::complex<double> const>, std::span<escape_t>, int, double, double);
+
+    void exp(std::span<std::complex<double> const> points, std::span<std::complex<double>> results)
+    {
+        switch (simd::active())
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: avx512::exp(points.data(), results.data(), points.size()); break;
+            case simd::isa::avx2:   avx2  ::exp(points.data(), results.data(), points.size()); break;
+#endif
+            default:                scalar::exp(points.data(), results.data(), points.size()); break;
+        }
+    }
+
+    template<typename T>
+    void newton(std::span<std::complex<double> const> points, std::span<int> results, roots_t const& roots, int cap, double eps)
+    {
+        switch (simd::active())
+        {
+#if defined(FRACTALGEN_SIMD_X86)
+            case simd::isa::avx512: avx512::newton<T>(points.data(), results.data(), points.size(), roots, cap, eps); break;
+            case simd::isa::avx2:   avx2  ::newton<T>(points.data(), results.data(), points.size(), roots, cap, eps); break;
+#endif
+            default:                scalar::newton<T>(points.data(), results.data(), points.size(), roots, cap, eps); break;
+        }
+    }
+
+    template void newton<float>(std::span<std::complex<double> const>, std::span<int>, roots_t const&, int, double);
+    template void newton<double>(std::span<std::complex<double> const>, std::span<int>, roots_t const&, int, double);
+
+}
\ No newline at end of file
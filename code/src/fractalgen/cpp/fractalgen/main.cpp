@@ -2,9 +2,13 @@
 #include <ctime>
 
 #include <algorithm>
+#include <chrono>
 #include <complex>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <sstream>
 #include <thread>
 #include <tuple>
@@ -18,38 +22,160 @@
 
 #include <stf/stf.hpp>
 
+#include "fractalgen/benchmark.hpp"
 #include "fractalgen/generators/generators.hpp"
 #include "fractalgen/generators/factory.hpp"
+#include "fractalgen/generators/field.hpp"
 #include "fractalgen/options.hpp"
+#include "fractalgen/simd/isa.hpp"
+#include "fractalgen/threading/thread_pool.hpp"
 
 namespace fractalgen
 {
 
-    int generate(options const& opts)
+    std::string png_name(std::string const& name)
     {
-        std::unique_ptr<generators::generator> generator = generators::factory(opts.config());
+        std::string suffix = ".png";
+        return name.ends_with(suffix) ? name : name + suffix;
+    }
+
+    bool write_png(std::string const& filename, generators::window_t const& window, std::vector<rgb_t> const& pixels)
+    {
+        std::vector<unsigned char> bytes;
+        bytes.reserve(3 * pixels.size());
+        std::for_each(pixels.begin(), pixels.end(), [&bytes](rgb_t const& c) { bytes.push_back(c.r); bytes.push_back(c.g); bytes.push_back(c.b); });
+        int status = stbi_write_png(filename.c_str(), window.width, window.height, 3, bytes.data(), window.width * 3);
+        return status != 0;
+    }
+
+    // if fields is non-null it receives the fields of the render (see generators::generator::generate)
+    int generate(options const& opts, threading::thread_pool& pool, std::vector<generators::field_t>* fields = nullptr)
+    {
+        generators::window_t window = opts.window();
+        generators::config cfg = opts.config();
+        cfg.precision = generators::choose_precision(cfg.precision, window);
+
+        std::unique_ptr<generators::generator> generator = generators::factory(cfg);
         if (generator)
         {
-            generators::window_t window = opts.window();
-            std::vector<rgb_t> pixels = generator->generate(window);
+            if (cfg.precision == generators::precision_t::f32) { std::cout << "Iterating in single precision" << std::endl; }
 
-            // save to png
-            std::vector<unsigned char> bytes;
-            bytes.reserve(3 * pixels.size());
-            std::for_each(pixels.begin(), pixels.end(), [&bytes](rgb_t const& c) { bytes.push_back(c.r); bytes.push_back(c.g); bytes.push_back(c.b); });
-            std::string filename = opts.name;
-            std::string suffix = ".png";
-            if (!filename.ends_with(suffix))
+            // overwrite the preview after each level so it always shows the latest one
+            generators::preview_fn preview;
+            if (!opts.preview.empty())
             {
-                filename += suffix;
+                preview = [&](std::vector<rgb_t> const& pixels) { write_png(png_name(opts.preview), window, pixels); };
             }
-            int status = stbi_write_png(filename.c_str(), window.width, window.height, 3, bytes.data(), window.width * 3);
-            bool success = status != 0;
+
+            std::vector<generators::field_t> local;
+            if (fields == nullptr && !opts.field.empty()) { fields = &local; }
+            std::vector<rgb_t> pixels = generator->generate(window, pool, preview, fields);
+
+            if (!opts.field.empty() && !generators::save(opts.field, cfg, window, *fields))
+            {
+                std::cerr << "Could not write field file " << opts.field << std::endl;
+                return 1;
+            }
+
+            // save to png
+            bool success = write_png(png_name(opts.name), window, pixels);
             if (!success) { return 1; }
         }
         return 0;
     }
 
+    // shade fields with the generator described by cfg and write the image to name.png
+    int shade(std::string const& name, generators::config const& cfg, generators::window_t const& window, std::span<generators::field_t const> fields, threading::thread_pool& pool)
+    {
+        std::unique_ptr<generators::generator> generator = generators::factory(cfg);
+        if (!generator) { return 1; }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<rgb_t> pixels = generator->recolor(window, fields, pool);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Recolored " << fields.size() << " samples in " << std::fixed << std::setprecision(1) << elapsed << " ms" << std::endl;
+
+        bool success = write_png(png_name(name), window, pixels);
+        return success ? 0 : 1;
+    }
+
+    int recolor(options const& opts, threading::thread_pool& pool)
+    {
+        std::optional<generators::field_file> file = generators::load(opts.recolor.field);
+        if (!file)
+        {
+            std::cerr << "Could not read field file " << opts.recolor.field << std::endl;
+            return 1;
+        }
+
+        opts.recolor.augment(file->cfg);
+        return shade(opts.name, file->cfg, file->window, file->fields, pool);
+    }
+
+    std::optional<options> parse_job(std::string const& line);
+
+    // render every job in a batch on the same thread pool. jobs that only differ in color are grouped so their shared
+    // geometry is rendered once (by the first job in the group) and its fields are shaded for the others
+    int batch(options const& opts, threading::thread_pool& pool)
+    {
+        std::ifstream file;
+        if (opts.batch.jobs != "-")
+        {
+            file.open(opts.batch.jobs);
+            if (!file)
+            {
+                std::cerr << "Could not read jobs from " << opts.batch.jobs << std::endl;
+                return 1;
+            }
+        }
+        std::istream& input = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+
+        // one job per line with the same arguments as a single render. blank lines and lines starting with # are skipped
+        std::vector<options> jobs;
+        std::string line;
+        while (std::getline(input, line))
+        {
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') { continue; }
+
+            std::optional<options> job = parse_job(line.substr(start));
+            if (!job) { return 1; }
+            jobs.push_back(*job);
+        }
+
+        // group the jobs by geometry, keeping groups in the order their first job was given
+        std::vector<std::vector<options const*>> groups;
+        std::map<std::string, size_t> indices;
+        for (options const& job : jobs)
+        {
+            auto [it, inserted] = indices.try_emplace(job.geometry(), groups.size());
+            if (inserted) { groups.emplace_back(); }
+            groups[it->second].push_back(&job);
+        }
+        std::cout << "Rendering " << groups.size() << " distinct geometries for " << jobs.size() << " jobs" << std::endl;
+
+        int status = 0;
+        for (std::vector<options const*> const& group : groups)
+        {
+            options const& first = *group.front();
+            std::vector<generators::field_t> fields;
+            status |= generate(first, pool, (group.size() > 1) ? &fields : nullptr);
+
+            for (size_t k = 1; k < group.size(); ++k)
+            {
+                options const& job = *group[k];
+                generators::window_t window = job.window();
+                if (!job.field.empty() && !generators::save(job.field, job.config(), window, fields))
+                {
+                    std::cerr << "Could not write field file " << job.field << std::endl;
+                    status = 1;
+                }
+                status |= shade(job.name, job.config(), window, fields, pool);
+            }
+        }
+        return status;
+    }
+
     void add_base_options(CLI::App& subcommand, options& opts)
     {
         subcommand.add_option("-n,--name", opts.name, "Name of the fractal (the output is written to name.png)")
@@ -61,8 +187,61 @@ namespace fractalgen
         subcommand.add_option("-b,--bounds", opts.bounds, "Bounds of the image in the complex plane. Format: min_x min_y max_x max_y")
             ->default_str("-4 -1.5 1.33 1.5");
 
+        CLI::Option* center = subcommand.add_option("--center", opts.center, "Center of the image in the complex plane, as decimals of any precision, for views too deep to give by their bounds. Format: real imag")
+            ->type_name("RE IM")
+            ->check([](std::string const& text) { return generators::coordinate_t::parse(text) ? std::string() : "not a decimal number: " + text; }, "DECIMAL");
+
+        CLI::Option* scale = subcommand.add_option("--scale", opts.scale, "Width of the image in the complex plane when it is given by its center, as a decimal of any magnitude (pixels narrower than about 1e-289 switch the offsets to a separate exponent)")
+            ->check([](std::string const& text)
+            {
+                std::optional<generators::coordinate_t> value = generators::coordinate_t::parse(text);
+                return (value && !value->is_zero() && !value->negative()) ? std::string() : "not a positive decimal number: " + text;
+            }, "POSITIVE")
+            ->needs(center);
+        center->needs(scale);
+
+        subcommand.add_option("--height", opts.height, "Height (in pixels) of the output image when it is given by its center")
+            ->check(CLI::PositiveNumber)
+            ->default_str("width")
+            ->needs(center);
+
         subcommand.add_option("-p,--phi", opts.phi, "Angle (in radians) by which to rotate the Riemann Sphere about the y-axis")
             ->capture_default_str();
+
+        subcommand.add_option("-s,--supersample", opts.supersample, "Number of samples per pixel along each axis (each pixel averages the square of this many samples)")
+            ->check(CLI::PositiveNumber)
+            ->capture_default_str();
+
+        subcommand.add_flag("-a,--adaptive", opts.adaptive, "Color each pixel with one sample first and only supersample pixels on an edge");
+
+        subcommand.add_option("--threshold", opts.threshold, "Difference (0-255) in any color channel between neighboring pixels that marks an edge in adaptive mode")
+            ->capture_default_str();
+
+        subcommand.add_option("--distance", opts.distance, "Distance (in pixel diagonals) from a boundary within which adaptive mode supersamples, for generators with a distance estimate (mandelbrot)")
+            ->check(CLI::PositiveNumber)
+            ->capture_default_str();
+
+        subcommand.add_flag("--subdivide", opts.subdivide, "Only color the border of each rectangle, filling rectangles whose border is a single color (mariani-silver). Ignored by generators that don't support it");
+
+        CLI::Option* progressive = subcommand.add_flag("--progressive", opts.progressive, "Color a coarse grid of pixels first and refine it level by level");
+
+        subcommand.add_option("--preview", opts.preview, "Write the image so far to this png after each progressive level")
+            ->needs(progressive);
+
+        subcommand.add_option("--field", opts.field, "Also write the field of every sample (iteration count or root index) to this file so the image can be recolored without rendering it again");
+
+        subcommand.add_option("-t,--threads", opts.threads, "Number of worker threads to render with")
+            ->default_str("hardware concurrency");
+
+        std::map<std::string, simd::isa> isas = { { "scalar", simd::isa::scalar }, { "avx2", simd::isa::avx2 }, { "avx512", simd::isa::avx512 } };
+        subcommand.add_option("--simd", opts.simd, "Instruction set used by the vectorized kernels (scalar, avx2, avx512)")
+            ->transform(CLI::CheckedTransformer(isas, CLI::ignore_case))
+            ->default_str(std::string(simd::name(simd::best())));
+
+        std::map<std::string, generators::precision_t> precisions = { { "auto", generators::precision_t::automatic }, { "float", generators::precision_t::f32 }, { "double", generators::precision_t::f64 } };
+        subcommand.add_option("--precision", opts.precision, "Type samples are iterated in (auto, float, double). auto picks float when the pixels are wide enough for it to resolve")
+            ->transform(CLI::CheckedTransformer(precisions, CLI::ignore_case))
+            ->default_str("auto");
     }
 
     void add_mandelbrot(CLI::App& app, options& opts)
@@ -78,6 +257,15 @@ namespace fractalgen
         mandelbrot->add_option("-d,--diverging", opts.mandelbrot.diverging, "The color (0-255) assigned to diverging inputs. Format: R G B")
             ->type_name("R G B")
             ->default_str("0 100 0");
+
+        mandelbrot->add_option("--period-tolerance", opts.mandelbrot.period_tolerance, "Distance at which an orbit is considered to have returned to a previous value (0 disables periodicity checking)")
+            ->capture_default_str();
+
+        mandelbrot->add_option("-i,--iterations", opts.mandelbrot.iterations, "Number of iterations after which a sample is taken to be bounded (0 is 500, raised with the depth of perturbed views past the resolution of double)")
+            ->check(CLI::NonNegativeNumber)
+            ->default_str("0");
+
+        mandelbrot->add_flag("--perturb", opts.mandelbrot.perturb, "Iterate each sample as a perturbation of a reference orbit at the center of the image, for zooms too deep for double precision coordinates. Ignored when phi is nonzero");
     }
 
     void add_powertower(CLI::App& app, options& opts)
@@ -93,6 +281,9 @@ namespace fractalgen
         powertower->add_option("-d,--diverging", opts.powertower.diverging, "The color (0-255) assigned to diverging inputs. Format: R G B")
             ->type_name("R G B")
             ->default_str("255 255 0");
+
+        powertower->add_option("--period-tolerance", opts.powertower.period_tolerance, "Distance at which an orbit is considered to have returned to a previous value (0 disables periodicity checking)")
+            ->capture_default_str();
     }
 
     void add_newton(CLI::App& app, options& opts)
@@ -109,6 +300,86 @@ namespace fractalgen
             ->type_name("REAL IMAG R G B");
     }
 
+    void add_recolor(CLI::App& app, options& opts)
+    {
+        CLI::App* recolor = app.add_subcommand("recolor", "Shade a field file written with --field using new colors");
+
+        recolor->add_option("field", opts.recolor.field, "The field file")
+            ->required();
+
+        recolor->add_option("-n,--name", opts.name, "Name of the fractal (the output is written to name.png)")
+            ->capture_default_str();
+
+        CLI::Option* color = recolor->add_option("-c,--color", opts.recolor.color, "The color (0-255) assigned to non-diverging inputs. Format: R G B")
+            ->type_name("R G B");
+
+        CLI::Option* diverging = recolor->add_option("-d,--diverging", opts.recolor.diverging, "The color (0-255) assigned to diverging inputs. Format: R G B")
+            ->type_name("R G B");
+
+        recolor->add_option("-r,--root", opts.recolor.roots, "Replace the color of the root with the given index (in the order the roots were given)")
+            ->type_name("INDEX R G B");
+
+        recolor->add_option("-t,--threads", opts.threads, "Number of worker threads to shade with")
+            ->default_str("hardware concurrency");
+
+        recolor->callback([&opts, color, diverging]()
+        {
+            opts.recolor.run = true;
+            opts.recolor.has_color = color->count() > 0;
+            opts.recolor.has_diverging = diverging->count() > 0;
+        });
+    }
+
+    void add_batch(CLI::App& app, options& opts)
+    {
+        CLI::App* batch = app.add_subcommand("batch", "Render many jobs, sharing the work between jobs that only differ in color");
+        batch->callback([&]() { opts.batch.run = true; });
+
+        batch->add_option("jobs", opts.batch.jobs, "File with one job per line, each with the arguments of a single render (e.g. mandelbrot --name a.png --diverging 0 0 153). Reads stdin if omitted or -")
+            ->capture_default_str();
+
+        batch->add_option("-t,--threads", opts.threads, "Number of worker threads shared by every job")
+            ->default_str("hardware concurrency");
+
+        std::map<std::string, simd::isa> isas = { { "scalar", simd::isa::scalar }, { "avx2", simd::isa::avx2 }, { "avx512", simd::isa::avx512 } };
+        batch->add_option("--simd", opts.simd, "Instruction set used by the vectorized kernels (scalar, avx2, avx512)")
+            ->transform(CLI::CheckedTransformer(isas, CLI::ignore_case))
+            ->default_str(std::string(simd::name(simd::best())));
+    }
+
+    // parse a batch job with the render subcommands. per-job threads and instruction sets are ignored in favor of the
+    // batch's
+    std::optional<options> parse_job(std::string const& line)
+    {
+        CLI::App app{"", "fractalgen"};
+        app.require_subcommand(1);
+
+        options opts;
+        add_mandelbrot(app, opts);
+        add_powertower(app, opts);
+        add_newton(app, opts);
+
+        try
+        {
+            app.parse(line, false);
+        }
+        catch (CLI::ParseError const& e)
+        {
+            std::cerr << "Could not parse job \"" << line << "\": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+        return opts;
+    }
+
+    void add_benchmark(CLI::App& app, options& opts)
+    {
+        CLI::App* benchmark = app.add_subcommand("benchmark", "Check the vectorized kernels against the scalar std::complex code and time them");
+        benchmark->callback([&]() { opts.benchmark.run = true; });
+
+        benchmark->add_option("-s,--samples", opts.benchmark.samples, "Number of samples each kernel is run on")
+            ->capture_default_str();
+    }
+
     int main(int argc, char** argv)
     {
         CLI::App app{"fractalgen is a tool that generates images by coloring the complex plane.", "fractalgen"};
@@ -118,10 +389,25 @@ namespace fractalgen
         add_mandelbrot(app, opts);
         add_powertower(app, opts);
         add_newton(app, opts);
+        add_recolor(app, opts);
+        add_batch(app, opts);
+        add_benchmark(app, opts);
 
         CLI11_PARSE(app, argc, argv);
 
-        return generate(opts);
+        if (opts.benchmark.run) { return benchmark::run(opts.benchmark); }
+
+        if (!simd::supported(opts.simd))
+        {
+            std::cerr << "Instruction set " << simd::name(opts.simd) << " is not supported on this machine" << std::endl;
+            return 1;
+        }
+        simd::select(opts.simd);
+
+        threading::thread_pool pool(opts.threads);
+        if (opts.recolor.run) { return recolor(opts, pool); }
+        if (opts.batch.run) { return batch(opts, pool); }
+        return generate(opts, pool);
     }
 
 }
@@ -0,0 +1,96 @@
+#include "fractalgen/simd/isa.hpp"
+
+#include <atomic>
+
+#if defined(FRACTALGEN_SIMD_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace fractalgen::simd
+{
+
+#if defined(FRACTALGEN_SIMD_X86)
+
+#if defined(_MSC_VER)
+
+    // msvc has no equivalent of __builtin_cpu_supports so we query cpuid directly
+    static bool detect(isa target)
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) { return false; }
+
+        // the os must have enabled saving of the ymm (and zmm) registers for us to use them
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave) { return false; }
+        unsigned long long xcr0 = _xgetbv(0);
+
+        __cpuidex(info, 7, 0);
+        switch (target)
+        {
+            case isa::avx2:   return (xcr0 & 0x06) == 0x06 && (info[1] & (1 << 5)) != 0;
+            case isa::avx512: return (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+            default: return false;
+        }
+    }
+
+#else
+
+    static bool detect(isa target)
+    {
+        __builtin_cpu_init();
+        switch (target)
+        {
+            case isa::avx2:   return __builtin_cpu_supports("avx2");
+            case isa::avx512: return __builtin_cpu_supports("avx512f");
+            default: return false;
+        }
+    }
+
+#endif
+
+#else
+
+    static bool detect(isa /* target */) { return false; }
+
+#endif
+
+    std::string_view name(isa target)
+    {
+        switch (target)
+        {
+            case isa::scalar: return "scalar";
+            case isa::avx2:   return "avx2";
+            case isa::avx512: return "avx512";
+            default: return "unknown";
+        }
+    }
+
+    bool supported(isa target)
+    {
+        if (target == isa::scalar) { return true; }
+        static bool const avx2 = detect(isa::avx2);
+        static bool const avx512 = detect(isa::avx512);
+        return (target == isa::avx2) ? avx2 : avx512;
+    }
+
+    isa best()
+    {
+        if (supported(isa::avx512)) { return isa::avx512; }
+        if (supported(isa::avx2)) { return isa::avx2; }
+        return isa::scalar;
+    }
+
+    static std::atomic<isa>& selected()
+    {
+        static std::atomic<isa> s_selected = best();
+        return s_selected;
+    }
+
+    isa active() { return selected().load(std::memory_order_relaxed); }
+
+    void select(isa target) { selected().store(target, std::memory_order_relaxed); }
+
+}
\ No newline at end of file
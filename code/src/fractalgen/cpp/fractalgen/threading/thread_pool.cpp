@@ -0,0 +1,61 @@
+#include "fractalgen/threading/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace fractalgen::threading
+{
+
+    thread_pool::thread_pool(size_t count) : m_stopping(false)
+    {
+        if (count == 0)
+        {
+            // hardware_concurrency is allowed to return 0 when it can't be determined
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        m_threads.reserve(count);
+        for (size_t t = 0; t < count; ++t)
+        {
+            m_threads.push_back(std::thread([this]() { run(); }));
+        }
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (std::thread& thread : m_threads) { thread.join(); }
+    }
+
+    std::future<void> thread_pool::submit(std::function<void()> task)
+    {
+        std::packaged_task<void()> packaged(std::move(task));
+        std::future<void> future = packaged.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(packaged));
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    void thread_pool::run()
+    {
+        while (true)
+        {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) { return; }        // only reachable when stopping
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+}
\ No newline at end of file
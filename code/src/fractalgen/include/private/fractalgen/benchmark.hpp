@@ -0,0 +1,15 @@
+#pragma once
+
+#include "fractalgen/options.hpp"
+
+namespace fractalgen::benchmark
+{
+
+    /**
+     * Checks the vectorized kernels against straightforward std::complex implementations and times both on every
+     * instruction set this machine supports. Results are printed to stdout -- returns a nonzero status if a kernel
+     * is out of tolerance.
+     */
+    int run(options::benchmark_opts const& opts);
+
+}
\ No newline at end of file
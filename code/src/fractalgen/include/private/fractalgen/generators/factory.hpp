@@ -27,6 +27,12 @@ namespace fractalgen::generators
         using root = std::array<double, 5>;
         std::vector<root> roots;
         std::complex<double> scale;
+        double period_tolerance = 0.0;
+        int iterations = 0;                 // the mandelbrot cap, resolved for the window with choose_iterations
+        bool perturb = false;
+
+        // resolved for the window with choose_precision before rendering
+        precision_t precision = precision_t::automatic;
 
         config(types _type, double _phi) : type(_type), phi(_phi) {}
     };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "fractalgen/generators/factory.hpp"
+#include "fractalgen/generators/generators.hpp"
+
+namespace fractalgen::generators
+{
+
+    /**
+     * The fields of a render along with everything needed to shade them again: the config of the generator that
+     * computed them and the window they were sampled on
+     */
+    struct field_file
+    {
+        config cfg;
+        window_t window;
+        std::vector<field_t> fields;
+    };
+
+    // write a field file. the file is a fixed size header followed by the roots (for newton) and then the fields as
+    // they are laid out in memory, starting at a 64 byte aligned offset so the file can be memory mapped. returns false
+    // if the file could not be written
+    bool save(std::string const& path, config const& cfg, window_t const& window, std::span<field_t const> fields);
+
+    // read a file written by save -- returns nothing if the file can't be read or is not a field file
+    std::optional<field_file> load(std::string const& path);
+
+}
\ No newline at end of file
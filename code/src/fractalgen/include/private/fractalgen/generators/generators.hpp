@@ -2,34 +2,123 @@
 
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
 
+#include <atomic>
 #include <complex>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <vector>
 
-#include <stf/math/transform.hpp>
 #include <stf/stf.hpp>
 
+#include "fractalgen/generators/mobius.hpp"
+#include "fractalgen/kernels/kernels.hpp"
+#include "fractalgen/numbers/bigfloat.hpp"
+#include "fractalgen/numbers/floatexp.hpp"
 #include "fractalgen/rgb.hpp"
+#include "fractalgen/threading/thread_pool.hpp"
 
 namespace fractalgen::generators
 {
 
+    // coordinates that need more precision than a double -- 2048 bits is enough for zooms to about 1e-600
+    using coordinate_t = numbers::bigfloat<32>;
+
+    // the type generators iterate samples in. float doubles the lanes of every kernel but only resolves coarse views
+    enum class precision_t
+    {
+        automatic,
+        f32,
+        f64,
+    };
+
     struct window_t
     {
-        stfd::aabb2 bounds;
+        stfd::aabb2 bounds;     // rounded to double when the window is given by its center
         int width;
         int height;
 
+        // the pixel spacing and insets are in units of 2^exponent, which is only nonzero for views so deep that they
+        // would underflow a double
         double delta_x;
         double delta_y;
 
+        int samples_sqrt;       // supersamples per pixel along each axis
+
         double inset_x;
         double inset_y;
 
-        window_t(stfd::aabb2 const& _bounds, int _width);
+        int64_t exponent = 0;
+
+        // the center of the view at full precision. relative generators sample offsets from it
+        coordinate_t center_x;
+        coordinate_t center_y;
+
+        // when adaptive, pixels are first colored with one sample and only the pixels whose color differs from a
+        // neighbor's by more than threshold (in some channel) are supersampled
+        bool adaptive = false;
+        double threshold = 0.0;
+
+        // generators that estimate the distance to the nearest boundary between colors replace the neighbor comparison
+        // with it -- adaptive mode then supersamples the pixels within this many pixel diagonals of a boundary
+        double distance = 2.0;
+
+        // when subdividing (and the generator's regions are simply connected) only the border of each rectangle is
+        // colored -- a rectangle whose border is a single color is filled and any other rectangle is split
+        bool subdivide = false;
+
+        // when progressive, pixels are first colored on a coarse grid that is refined level by level (each pixel is
+        // still only colored once). takes precedence over subdividing
+        bool progressive = false;
+
+        window_t(stfd::aabb2 const& _bounds, int _width, int _samples_sqrt);
+
+        // a view that is scale wide in the complex plane (with square pixels) around a high precision center
+        window_t(coordinate_t const& _center_x, coordinate_t const& _center_y, numbers::floatexp const& _scale, int _width, int _height, int _samples_sqrt);
+
+        int samples() const { return samples_sqrt * samples_sqrt; }
 
     };
 
+    // resolve automatic to float when float's spacing at the magnitude of the bounds is a small fraction of the pixel
+    // spacing, and to double otherwise (always for views in units of 2^exponent). any other precision is kept
+    precision_t choose_precision(precision_t requested, window_t const& window);
+
+    // the mandelbrot iteration cap for the window: requested if it is positive, and otherwise 500 unless the view is
+    // perturbed past the resolution of double, where it grows with the depth of the view
+    int choose_iterations(int requested, bool perturb, window_t const& window);
+
+    /**
+     * A rectangle of pixels [min_i, max_i) x [min_j, max_j) within a window
+     */
+    struct tile_t
+    {
+        int min_i;
+        int min_j;
+        int max_i;
+        int max_j;
+
+        size_t size() const { return static_cast<size_t>(max_i - min_i) * (max_j - min_j); }
+    };
+
+    /**
+     * What a generator computes for a sample before it is shaded. escape time generators store the iteration count and
+     * whether the orbit stayed bounded, newton stores the index of the root the sample converged to (-1 for none) and
+     * whether it converged. both members are 32 bits so there is no padding and buffers can be written out as is
+     */
+    struct field_t
+    {
+        int32_t value;
+        int32_t bounded;
+    };
+
+    // receives an approximation of the image (each colored pixel standing in for the block around it) after each
+    // level of a progressive render
+    using preview_fn = std::function<void(std::vector<rgb_t> const& pixels)>;
+
     /**
      * Interface that provides a function to color an element of the complex plane
      */
@@ -40,113 +129,218 @@ namespace fractalgen::generators
         generator(double _phi);
         virtual ~generator() = default;
 
-        std::vector<rgb_t> generate(window_t const& window) const;
+        // if fields is non-null it receives the field of every sample, window.samples() per pixel in the order
+        // supersample writes them (a pixel colored with fewer samples has its fields repeated)
+        std::vector<rgb_t> generate(window_t const& window, threading::thread_pool& pool, preview_fn const& preview = {}, std::vector<field_t>* fields = nullptr) const;
+
+        // the shading phase on its own: color each pixel of the window by averaging the shades of its fields
+        std::vector<rgb_t> recolor(window_t const& window, std::span<field_t const> fields, threading::thread_pool& pool) const;
 
         rgb_t color_pixel(window_t const& window, int i, int j) const;
 
-        virtual rgb_t color_complex_num(std::complex<double> const& num) const = 0;
+        // write the points in the complex plane that are sampled (and averaged) to color pixel (i, j) -- as offsets from
+        // the window's center for relative generators
+        void supersample(window_t const& window, int i, int j, std::span<std::complex<double>> samples) const;
+
+        // compute and shade numbers in one go
+        rgb_t color_complex_num(std::complex<double> const& num) const;
+        void color_complex_nums(std::span<std::complex<double> const> nums, std::span<rgb_t> colors) const;
+
+        // the render phase: compute the field of each number in a batch (generate passes a whole tile's worth of
+        // samples at once). if distances is non-empty (only when estimates_distance is true) it receives each number's
+        // estimated distance to the nearest boundary between colors -- 0 for numbers inside a region the estimate does
+        // not cover and nan if unknown
+        virtual void compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> distances) const = 0;
+
+        // the shading phase: the color of a sample with the given field
+        virtual rgb_t shade(field_t const& field) const = 0;
+
+        // whether compute can estimate the distance from each number to the nearest boundary between colors
+        virtual bool estimates_distance() const { return false; }
 
         virtual std::string_view const name() const = 0;
 
+        // relative generators compute from offsets to the window's center instead of absolute points, which keeps pixels
+        // distinct long after they would round to the same double. they must be prepared for the window first
+        virtual bool relative() const { return false; }
+
+        // set up whatever compute needs for the given window (generate calls this before rendering)
+        virtual void prepare(window_t const& /* window */) const {}
+
+        // whether a region of the (unrotated) complex plane whose border is a single color can be filled without
+        // coloring its interior -- true when each set of points with the same color is simply connected, for example
+        virtual bool simply_connected() const { return false; }
+
+        // for generators whose regions of one color are nested around a point rather than simply connected, that
+        // point. a rectangle around it can hide other colors behind a border of one color, so it is never filled
+        virtual std::optional<std::complex<double>> nested_around() const { return std::nullopt; }
+
+        // generators that gather statistics while rendering override these. generate resets them before rendering
+        // and prints them afterwards
+        virtual void reset_stats() const {}
+        virtual void print_stats(std::ostream& /* stream */) const {}
+
     private:
 
         double m_phi;
 
-        static stfd::vec3 to_riemann_sphere(std::complex<double> const& num);
+        // maps the image space to the preimage that is sampled -- only applied when phi is nonzero
+        mobius_t m_rotation;
 
-        static std::complex<double> to_complex(stfd::vec3 const& vec);
+    };
 
+    /**
+     * Iteration counters for escape time generators, accumulated from kernels::escape_t results
+     */
+    struct iteration_stats
+    {
+        std::atomic<uint64_t> performed = 0;    // iterations computed
+        std::atomic<uint64_t> skipped = 0;      // iterations skipped by closed form interior tests
+        std::atomic<uint64_t> saved = 0;        // iterations saved by periodicity checking
+        std::atomic<uint64_t> glitched = 0;     // rebases of perturbed points after a glitch (see kernels::perturbed_t)
+        std::atomic<uint64_t> overrun = 0;      // rebases of perturbed points at the end of the reference
+        std::atomic<uint64_t> approximated = 0; // iterations skipped by the series approximation
+        std::atomic<uint64_t> samples = 0;
+
+        void reset();
+
+        // a bounded escape with 0 iterations was resolved by an interior test and one with fewer than cap iterations
+        // was resolved by periodicity checking. approximated of the escapes' iterations were skipped rather than
+        // performed
+        void accumulate(std::span<kernels::escape_t const> escapes, int cap, uint64_t approximated = 0);
+
+        void print(std::ostream& stream) const;
     };
 
     /**
-     * class that colors a complex number according to the iterative rule z_n+1 = (z_n)^2 + c
+     * class that colors a complex number according to the iterative rule z_n+1 = (z_n)^2 + c, iterated in T (float or
+     * double)
      */
+    template<typename T>
     class mandelbrot : public generator
     {
     private:
 
         rgb_t m_color;
         stfd::vec3 m_diverging;
+        double m_period_tolerance;
+        int m_cap;
+        bool m_perturb;
+
+        // the reference orbit at the window center when perturbing, and the exponent of the window's units
+        mutable std::vector<double> m_orbit_re;
+        mutable std::vector<double> m_orbit_im;
+        mutable int64_t m_exponent = 0;
+        mutable double m_tolerance = 0.0;       // the period tolerance scaled to the window's pixel spacing
+
+        // the series approximation around the reference orbit (see kernels::series_t)
+        mutable std::vector<double> m_series_re;
+        mutable std::vector<double> m_series_im;
+        mutable std::vector<int64_t> m_series_exponent;
+        mutable std::vector<double> m_series_radius;
+
+        mutable iteration_stats m_stats;
 
     public:
 
-        mandelbrot(double phi, rgb_t color, rgb_t diverging);
+        // when perturb is set (and phi is 0) each sample is iterated as a perturbation of a reference orbit computed at
+        // high precision at the window center, which keeps deep zooms from breaking up into blocks. the iterations
+        // every sample of a deep zoom shares with the reference are skipped with a series approximation. perturbations
+        // are always iterated in double, since they are only needed past the resolution of float. samples that reach
+        // cap iterations (and the reference orbit, if it does) are taken to be bounded
+        mandelbrot(double phi, rgb_t color, rgb_t diverging, double period_tolerance, int cap, bool perturb = false);
 
-        rgb_t color_complex_num(std::complex<double> const& num) const override;
+        void compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> distances) const override;
+
+        rgb_t shade(field_t const& field) const override;
 
         std::string_view const name() const override { return "mandelbrot"; }
 
+        // the bands of equal escape time are annuli, not simply connected. but the set is connected, so each region
+        // {escape time >= k} is connected and has no holes. inside a rectangle whose border is all band k a lower band
+        // would have to reach infinity across the border, and a higher band's region would have to lie entirely
+        // inside the rectangle -- which means surrounding the set, and so the origin
+        bool simply_connected() const override { return true; }
+        std::optional<std::complex<double>> nested_around() const override { return 0.0; }
+
+        // the exterior distance estimate is tracked by the kernel. bands of equal escape time differ by less than one
+        // color step so the set's boundary is the only boundary between colors that needs antialiasing
+        bool estimates_distance() const override { return true; }
+
+        bool relative() const override { return m_perturb; }
+        void prepare(window_t const& window) const override;
+
+        void reset_stats() const override;
+        void print_stats(std::ostream& stream) const override;
+
     };
 
     /**
-     * class that colors a complex number c according to the iterative rule z_n+1 = num^z_n where z_0 = num
+     * class that colors a complex number c according to the iterative rule z_n+1 = num^z_n where z_0 = num, iterated in
+     * T (float or double)
      */
+    template<typename T>
     class powertower : public generator
     {
     private:
 
         rgb_t m_color;
         stfd::vec3 m_diverging;
+        double m_period_tolerance;
+
+        mutable iteration_stats m_stats;
 
     public:
 
-        powertower(double phi, rgb_t color, rgb_t diverging);
+        powertower(double phi, rgb_t color, rgb_t diverging, double period_tolerance);
+
+        void compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> distances) const override;
 
-        rgb_t color_complex_num(std::complex<double> const& num)const override;
+        rgb_t shade(field_t const& field) const override;
 
         std::string_view const name() const override { return "powertower"; }
 
+        void reset_stats() const override;
+        void print_stats(std::ostream& stream) const override;
+
+    };
+
+    // a root of the polynomial newton's method is run on and the color of the points that converge to it
+    struct root_t
+    {
+        std::complex<double> z;
+        rgb_t color;
     };
 
     /**
-     * class that colors a complex number c according to newton's method for finding zeros of a function
+     * class that colors a complex number c according to newton's method for finding zeros of a function, with the
+     * steps taken in T (float or double)
      */
+    template<typename T>
     class newton : public generator
     {
     public:
 
-        struct root
-        {
-            std::complex<double> z;
-            rgb_t color;
-        };
-
-    private:
-
-        struct function
-        {
-
-            std::vector<root> roots;
-
-            std::complex<double> evaluate(std::complex<double> const& z) const;
-            std::complex<double> evaluate_deriv(std::complex<double> const& z) const;
-
-        private:
-
-            using iter = std::vector<root>::const_iterator;
+        newton(double phi, rgb_t diverging, std::vector<root_t> const& roots);
 
-            static std::complex<double> evaluate(iter begin, iter end, std::complex<double> const& z);
-            static std::complex<double> evaluate_deriv(iter begin, iter end, std::complex<double> const& z);
+        void compute(std::span<std::complex<double> const> nums, std::span<field_t> fields, std::span<double> distances) const override;
 
-        };
-
-        std::complex<double> newtons_method(std::complex<double> const& z, double eps) const;
-
-        // method to return the index of the zeros array within eps (a small value)
-        int index(std::complex<double> const& z, double eps) const;
-
-    public:
-
-        newton(double phi, rgb_t diverging, std::vector<root> const& roots);
-
-        rgb_t color_complex_num(std::complex<double> const& z) const override;
+        rgb_t shade(field_t const& field) const override;
 
         std::string_view const name() const override { return "newton"; }
 
+        // the fatou components of a polynomial's newton map are simply connected
+        bool simply_connected() const override { return true; }
+
     private:
 
         rgb_t m_diverging;
-        function m_function;
+        std::vector<root_t> m_roots;
+
+        // the roots and their squared capture radii laid out for the kernel
+        std::vector<double> m_re;
+        std::vector<double> m_im;
+        std::vector<double> m_radius_sq;
 
     };
 
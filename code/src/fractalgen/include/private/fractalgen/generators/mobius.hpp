@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cfloat>
+#include <complex>
+
+#include <stf/stf.hpp>
+
+namespace fractalgen::generators
+{
+
+    /**
+     * A mobius transform z -> (az + b) / (cz + d). Rotations of the riemann sphere (with the stereographic projection
+     * z -> (2x, 2y, |z|^2 - 1) / (|z|^2 + 1)) are exactly the transforms with c = -conj(b), d = conj(a), and
+     * |a|^2 + |b|^2 = 1, so rotating a point costs a few multiplies and one division instead of a trip through the
+     * sphere and back.
+     */
+    struct mobius_t
+    {
+        std::complex<double> a = 1.0;
+        std::complex<double> b = 0.0;
+        std::complex<double> c = 0.0;
+        std::complex<double> d = 1.0;
+
+        // the transform that rotates the riemann sphere by angle (in radians, counterclockwise looking down the axis)
+        // about the axis through the origin
+        static mobius_t rotation(stfd::vec3 const& axis, double angle);
+
+        // the point mapped to infinity (the north pole) is returned as (DBL_MAX, DBL_MAX)
+        std::complex<double> operator()(std::complex<double> const& z) const
+        {
+            // written out in real arithmetic since std::complex division goes through a slow runtime helper
+            double x = z.real();
+            double y = z.imag();
+            double num_re = a.real() * x - a.imag() * y + b.real();
+            double num_im = a.real() * y + a.imag() * x + b.imag();
+            double den_re = c.real() * x - c.imag() * y + d.real();
+            double den_im = c.real() * y + c.imag() * x + d.imag();
+
+            double mag_sq = den_re * den_re + den_im * den_im;
+            if (mag_sq == 0.0) { return { DBL_MAX, DBL_MAX }; }
+            return { (num_re * den_re + num_im * den_im) / mag_sq, (num_im * den_re - num_re * den_im) / mag_sq };
+        }
+    };
+
+}
\ No newline at end of file
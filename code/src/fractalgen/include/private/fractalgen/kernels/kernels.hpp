@@ -0,0 +1,107 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fractalgen::kernels
+{
+
+    /**
+     * The outcome of iterating a point: the number of iterations performed and whether the orbit stayed bounded.
+     * Bounded orbits that stopped short of the cap were either proven bounded up front (0 iterations) or detected
+     * as periodic.
+     */
+    struct escape_t
+    {
+        int iterations;
+        bool bounded;
+    };
+
+    /**
+     * Polynomial roots in structure of arrays layout, each with the squared radius of a disk around it in which
+     * newton's method is guaranteed to converge to that root
+     */
+    struct roots_t
+    {
+        double const* re;
+        double const* im;
+        double const* radius_sq;
+        size_t count;
+    };
+
+    /**
+     * The reference orbit Z_0 = 0, Z_1 = C, ... of a point C in structure of arrays layout, computed at higher
+     * precision and rounded to double. It ends after the cap or once it escapes, and always has at least Z_0 and Z_1
+     */
+    struct orbit_t
+    {
+        double const* re;
+        double const* im;
+        size_t length;
+    };
+
+    /**
+     * The first order series approximation of points near a reference orbit. A point c = C + dc whose offset is below
+     * radius[s] in magnitude is (to double precision) at z_s = Z_s + coefficient_s dc after s iterations, with derivative
+     * dz_s/dc = coefficient_s, so the first s iterations can be skipped. Coefficients are stored as mantissas with an
+     * exponent since they grow far beyond the range of double on deep zooms, and the radii are in the units of the
+     * offsets. Radii never increase with s, and s stays below both the cap and the last index of the reference
+     */
+    struct series_t
+    {
+        double const* re;
+        double const* im;
+        int64_t const* exponent;
+        double const* radius;
+        size_t length;
+    };
+
+    // what the perturbation kernel did besides iterating
+    struct perturbed_t
+    {
+        uint64_t glitched = 0;          // rebases onto the start of the reference orbit because |z| < |d|
+        uint64_t overrun = 0;           // rebases onto the start of the reference orbit at its end
+        uint64_t approximated = 0;      // iterations skipped with the series approximation
+    };
+
+    // iterate z_n+1 = (z_n)^2 + c with z_0 = 0 for each point c until |z_n| > 2, cap iterations have been performed,
+    // or the orbit returns within tolerance of a previous value (0 disables periodicity checking). if distances is
+    // non-empty it receives each point's estimated distance to the set (0 for points proven bounded and nan for points
+    // that reach the cap). the points are iterated in T (float or double), rounded to it once they have passed the
+    // interior tests. work is dispatched to the kernel for simd::active()
+    template<typename T>
+    void mandelbrot(std::span<std::complex<double> const> points, std::span<escape_t> results, int cap, double tolerance, std::span<double> distances = {});
+
+    // the mandelbrot iteration for the points C + offset (where C is the orbit's point) carried out as perturbations of
+    // the reference orbit, so offsets far below the precision of C still render distinct points. each point starts by
+    // skipping as many iterations as the series approximation allows (pass an empty series to disable). results and
+    // distances are as for mandelbrot except that no point is proven bounded up front. the offsets (and distances)
+    // are in units of 2^exponent -- a nonzero exponent selects the slower kernel that keeps the offsets in a separate
+    // exponent, for zooms too deep for double. work is dispatched to the kernel for simd::active()
+    perturbed_t perturbation(std::span<std::complex<double> const> offsets, int64_t exponent, std::span<escape_t> results, orbit_t const& orbit, series_t const& series, int cap, double tolerance, std::span<double> distances = {});
+
+    // build the series approximation around the orbit for offsets in units of 2^exponent, with entries up to the cap.
+    // the vectors are refilled and the returned series points into them
+    series_t approximate(orbit_t const& orbit, int64_t exponent, int cap, std::vector<double>& re, std::vector<double>& im, std::vector<int64_t>& exponents, std::vector<double>& radii);
+
+    // iterate z_n+1 = num^z_n with z_0 = num for each point num until |z_n| >= magnitude, cap iterations have been
+    // performed, or the orbit returns within tolerance of a previous value (0 disables periodicity checking). points
+    // in the shell-thron region are bounded after 0 iterations. the towers are iterated in T (float or double). work
+    // is dispatched to the kernel for simd::active()
+    template<typename T>
+    void powertower(std::span<std::complex<double> const> points, std::span<escape_t> results, int cap, double magnitude, double tolerance);
+
+    // the complex exponential used by the powertower kernel (exposed so it can be checked against std::exp)
+    void exp(std::span<std::complex<double> const> points, std::span<std::complex<double>> results);
+
+    // run newton's method on the polynomial with the given roots from each point until z lands in a capture disk,
+    // a step moves z by at most eps, or cap steps have been taken. the result is the index of the (lowest) capture
+    // disk that contains the final z or -1 if there is none. the steps are taken in T (float or double). work is
+    // dispatched to the kernel for simd::active()
+    template<typename T>
+    void newton(std::span<std::complex<double> const> points, std::span<int> results, roots_t const& roots, int cap, double eps);
+
+}
\ No newline at end of file
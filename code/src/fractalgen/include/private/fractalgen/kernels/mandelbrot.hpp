@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cmath>
+
+#include <complex>
+#include <cstddef>
+
+#include "fractalgen/kernels/kernels.hpp"
+
+// compiled once per instruction set -- see fractalgen/kernels/targets.hpp for what that allows
+namespace fractalgen::kernels::impl
+{
+
+    // closed-form membership tests for the main cardioid and the period-2 bulb -- both are contained in the set so
+    // every point inside them is bounded and would otherwise burn the whole iteration cap
+    static inline bool interior(double x, double y)
+    {
+        double y_sq = y * y;
+
+        // main cardioid: q(q + (x - 1/4)) <= y^2 / 4 where q = (x - 1/4)^2 + y^2
+        double shifted = x - 0.25;
+        double q = shifted * shifted + y_sq;
+        if (q * (q + shifted) <= 0.25 * y_sq) { return true; }
+
+        // period-2 bulb: the disk of radius 1/4 centered at -1
+        double left = x + 1.0;
+        return left * left + y_sq <= 0.0625;
+    }
+
+    /**
+     * Escape-time kernel written against a simd vector type V (see fractalgen/simd). Each lane iterates its own
+     * point and, as soon as a lane escapes, reaches the cap, or is found to be periodic, its result is written out
+     * and the lane is refilled with the next point so that every lane stays busy until the input is exhausted.
+     *
+     * Periodicity is detected with Brent's method: each lane saves z at iterations 1, 2, 4, 8, ... and the orbit is
+     * considered bounded once z comes within tolerance of the saved value.
+     *
+     * When estimate is set the derivative dz/dc is iterated alongside z (dz_n+1 = 2 z_n dz_n + 1) and each escaped
+     * point's distance to the set is estimated as |z| log|z| / |dz|. points proven bounded (by the interior tests or
+     * periodicity) are given a distance of 0 and points that reach the cap are given nan since they may be outside.
+     * a derivative that overflowed leaves the distance unknown (nan) as well -- it is only that large right at the
+     * boundary.
+     *
+     * The lanes hold V::value_type (float or double). Points are rounded to it as they are loaded, after the interior
+     * tests have classified them in double.
+     */
+    template<typename V, bool estimate>
+    void mandelbrot(std::complex<double> const* points, escape_t* results, double* distances, size_t count, int cap, double tolerance)
+    {
+        using real = typename V::value_type;
+        constexpr size_t width = V::width;
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* coords = reinterpret_cast<double const*>(points);
+
+        alignas(64) real cr[width];
+        alignas(64) real ci[width];
+        alignas(64) real zr[width];
+        alignas(64) real zi[width];
+        alignas(64) real sr[width];                 // saved z for periodicity checking
+        alignas(64) real si[width];
+        alignas(64) real save_at[width];            // iteration at which z is next saved
+        alignas(64) real iterations[width];
+        alignas(64) real dr[width];                 // dz/dc (only iterated when estimating distances)
+        alignas(64) real di[width];
+        size_t indices[width];
+
+        size_t next = 0;
+
+        // load the next point that needs iterating into the lane -- returns false once the input is exhausted
+        auto refill = [&](size_t lane)
+        {
+            double x = 0.0;
+            double y = 0.0;
+            bool found = false;
+            while (next < count && !found)
+            {
+                size_t k = next++;
+                x = coords[2 * k];
+                y = coords[2 * k + 1];
+                if (interior(x, y))
+                {
+                    results[k] = { 0, true };
+                    if constexpr (estimate) { distances[k] = 0.0; }
+                }
+                else
+                {
+                    indices[lane] = k;
+                    found = true;
+                }
+            }
+
+            // an exhausted lane is parked at the origin where it never escapes
+            if (!found) { x = 0.0; y = 0.0; }
+            cr[lane] = static_cast<real>(x); ci[lane] = static_cast<real>(y);
+            zr[lane] = 0; zi[lane] = 0;
+            sr[lane] = 0; si[lane] = 0;
+            save_at[lane] = 1;
+            iterations[lane] = 0;
+            dr[lane] = 0; di[lane] = 0;
+            return found;
+        };
+
+        unsigned live = 0;
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            if (refill(lane)) { live |= 1u << lane; }
+        }
+
+        V const one = V::broadcast(1.0);
+        V const four = V::broadcast(4.0);
+        V const limit = V::broadcast(static_cast<double>(cap));
+        V const tolerance_sq = V::broadcast(tolerance * tolerance);
+
+        V vcr = V::load(cr), vci = V::load(ci);
+        V vzr = V::load(zr), vzi = V::load(zi);
+        V vsr = V::load(sr), vsi = V::load(si);
+        V vsave_at = V::load(save_at);
+        V vn = V::load(iterations);
+        V vdr = V::load(dr), vdi = V::load(di);
+
+        while (live != 0)
+        {
+            // dz = 2 z dz + 1 (using z before it is updated)
+            if constexpr (estimate)
+            {
+                V re = vzr * vdr - vzi * vdi;
+                V im = vzr * vdi + vzi * vdr;
+                vdr = (re + re) + one;
+                vdi = im + im;
+            }
+
+            // z = z^2 + c
+            V x_sq = vzr * vzr;
+            V y_sq = vzi * vzi;
+            vzi = (vzr + vzr) * vzi + vci;
+            vzr = (x_sq - y_sq) + vcr;
+            vn = vn + one;
+
+            // compare squared magnitudes so there is no sqrt in the loop
+            typename V::mask escaped = (vzr * vzr + vzi * vzi) > four;
+
+            // compare against the saved value before (possibly) saving the current one
+            V er = vzr - vsr;
+            V ei = vzi - vsi;
+            typename V::mask periodic = (er * er + ei * ei) < tolerance_sq;
+            typename V::mask save = vn == vsave_at;
+            vsr = select(save, vzr, vsr);
+            vsi = select(save, vzi, vsi);
+            vsave_at = select(save, vsave_at + vsave_at, vsave_at);
+
+            unsigned done = (escaped | periodic | (vn >= limit)).bits() & live;
+            if (done != 0)
+            {
+                vcr.store(cr); vci.store(ci);
+                vzr.store(zr); vzi.store(zi);
+                vsr.store(sr); vsi.store(si);
+                vsave_at.store(save_at);
+                vn.store(iterations);
+                vdr.store(dr); vdi.store(di);
+
+                unsigned escaped_bits = escaped.bits();
+                for (size_t lane = 0; lane < width; ++lane)
+                {
+                    unsigned bit = 1u << lane;
+                    if ((done & bit) == 0) { continue; }
+
+                    bool bounded = (escaped_bits & bit) == 0;
+                    results[indices[lane]] = { static_cast<int>(iterations[lane]), bounded };
+                    if constexpr (estimate)
+                    {
+                        double x = zr[lane], y = zi[lane], u = dr[lane], v = di[lane];
+                        double mag = std::sqrt(x * x + y * y);
+                        double deriv = std::sqrt(u * u + v * v);
+                        double distance = mag * std::log(mag) / deriv;
+                        if (!(deriv < INFINITY)) { distance = NAN; }
+                        if (bounded) { distance = iterations[lane] < cap ? 0.0 : NAN; }
+                        distances[indices[lane]] = distance;
+                    }
+                    if (!refill(lane)) { live &= ~bit; }
+                }
+
+                vcr = V::load(cr); vci = V::load(ci);
+                vzr = V::load(zr); vzi = V::load(zi);
+                vsr = V::load(sr); vsi = V::load(si);
+                vsave_at = V::load(save_at);
+                vn = V::load(iterations);
+                vdr = V::load(dr); vdi = V::load(di);
+            }
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+/**
+ * Elementary functions written against a simd vector type V (see fractalgen/simd). They only use operations that
+ * round identically on every instruction set, so (like the kernels) each target computes bit-identical results.
+ */
+
+namespace fractalgen::kernels::impl
+{
+
+    // exp saturates outside of this range so that 2^n stays a normal number
+    static constexpr double c_exp_min = -708.0;
+    static constexpr double c_exp_max = 709.0;
+
+    static constexpr double c_inv_ln2 = 1.44269504088896338700e+00;
+    static constexpr double c_ln2_hi = 6.93147180369123816490e-01;         // ln(2) split so n * c_ln2_hi is exact
+    static constexpr double c_ln2_lo = 1.90821492927058770002e-10;
+
+    static constexpr double c_two_over_pi = 6.36619772367581382433e-01;
+    static constexpr double c_pio2_1 = 1.57079632673412561417e+00;         // pi/2 split into three 33 bit parts so
+    static constexpr double c_pio2_2 = 6.07710050630396597660e-11;         // n * part is exact for |n| < 2^20
+    static constexpr double c_pio2_3 = 2.02226624871116645580e-21;
+
+    // minimax polynomials for sin and cos on [-pi/4, pi/4] (from fdlibm's __kernel_sin and __kernel_cos)
+    static constexpr double c_sin[] = { -1.66666666666666324348e-01, 8.33333333332248946124e-03, -1.98412698298579493134e-04,
+                                        2.75573137070700676789e-06, -2.50507602534068634195e-08, 1.58969099521155010221e-10 };
+    static constexpr double c_cos[] = { 4.16666666666666019037e-02, -1.38888888888741095749e-03, 2.48015872894767294178e-05,
+                                        -2.75573143513906633035e-07, 2.08757232129817482790e-09, -1.13596475577881948265e-11 };
+
+    // 1/k! for k = 0, ..., 13
+    static constexpr double c_taylor[] = { 1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040,
+                                           1.0 / 40320, 1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800,
+                                           1.0 / 479001600, 1.0 / 6227020800 };
+
+    // the same for float lanes (cephes' sinf and cosf, and 1/k! for k = 0, ..., 7)
+    static constexpr double c_sin_float[] = { -1.6666654611e-1, 8.3321608736e-3, -1.9515295891e-4 };
+    static constexpr double c_cos_float[] = { 4.166664568298827e-2, -1.388731625493765e-3, 2.443315711809948e-5 };
+    static constexpr double c_taylor_float[] = { 1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040 };
+
+    /**
+     * The ranges, reduction constants, and polynomials for lanes of T. Float lanes need splits of ln(2) and pi/2 with
+     * few enough bits that n * part is exact in 24 bits, a range that keeps 2^n a normal float, and only as many terms
+     * as float can resolve (the splits and polynomials are cephes' expf, sinf, and cosf)
+     */
+    template<typename T>
+    struct constants
+    {
+        static constexpr double exp_min = c_exp_min;
+        static constexpr double exp_max = c_exp_max;
+        static constexpr double ln2_hi = c_ln2_hi;
+        static constexpr double ln2_lo = c_ln2_lo;
+        static constexpr double pio2_1 = c_pio2_1;
+        static constexpr double pio2_2 = c_pio2_2;
+        static constexpr double pio2_3 = c_pio2_3;
+        static constexpr auto& sin = c_sin;
+        static constexpr auto& cos = c_cos;
+        static constexpr auto& taylor = c_taylor;
+    };
+
+    template<>
+    struct constants<float>
+    {
+        static constexpr double exp_min = -87.0;
+        static constexpr double exp_max = 88.0;
+        static constexpr double ln2_hi = 0.693359375;
+        static constexpr double ln2_lo = -2.12194440e-4;
+        static constexpr double pio2_1 = 1.5703125;
+        static constexpr double pio2_2 = 4.837512969970703125e-4;
+        static constexpr double pio2_3 = 7.54978995489188216e-8;
+        static constexpr auto& sin = c_sin_float;
+        static constexpr auto& cos = c_cos_float;
+        static constexpr auto& taylor = c_taylor_float;
+    };
+
+    template<typename V, size_t N>
+    V horner(V x, double const (&coefficients)[N])
+    {
+        V result = V::broadcast(coefficients[N - 1]);
+        for (size_t k = N - 1; k > 0; --k)
+        {
+            result = result * x + V::broadcast(coefficients[k - 1]);
+        }
+        return result;
+    }
+
+    /**
+     * exp(x) with a relative error of a few ulp on [-708, 709] ([-87, 88] for float). x is reduced to r = x - n ln(2)
+     * with |r| <= ln(2)/2, exp(r) is evaluated with its taylor polynomial to degree 13 (truncation error below 1e-17,
+     * degree 7 for float) and scaled by 2^n.
+     */
+    template<typename V>
+    V exp(V x)
+    {
+        using k = constants<typename V::value_type>;
+
+        V const lo = V::broadcast(k::exp_min);
+        V const hi = V::broadcast(k::exp_max);
+        x = select(x < lo, lo, select(x > hi, hi, x));
+
+        V n = round(x * V::broadcast(c_inv_ln2));
+        V r = (x - n * V::broadcast(k::ln2_hi)) - n * V::broadcast(k::ln2_lo);
+        return horner(r, k::taylor) * pow2(n);
+    }
+
+    /**
+     * sin(x) and cos(x) with an error of a few ulp for |x| < 1e6 (|x| < 8192 for float). x is reduced to
+     * r = x - n pi/2 with |r| <= pi/4 and the polynomials for sin(r) and cos(r) are swapped and negated according to
+     * the quadrant n mod 4.
+     */
+    template<typename V>
+    void sincos(V x, V& sin_x, V& cos_x)
+    {
+        using k = constants<typename V::value_type>;
+
+        V const zero = V::broadcast(0.0);
+        V const one = V::broadcast(1.0);
+        V const two = V::broadcast(2.0);
+
+        V n = round(x * V::broadcast(c_two_over_pi));
+        V r = ((x - n * V::broadcast(k::pio2_1)) - n * V::broadcast(k::pio2_2)) - n * V::broadcast(k::pio2_3);
+        V r_sq = r * r;
+
+        V sin_r = r + r * r_sq * horner(r_sq, k::sin);
+        V cos_r = (one - V::broadcast(0.5) * r_sq) + r_sq * r_sq * horner(r_sq, k::cos);
+
+        // n mod 4 as one of -2, -1, 0, 1, 2 (where -2 and 2 are the same quadrant)
+        V q = n - V::broadcast(4.0) * round(n * V::broadcast(0.25));
+        V neg_one = zero - one;
+        V neg_two = zero - two;
+
+        typename V::mask odd = (q == one) | (q == neg_one);
+        V s = select(odd, cos_r, sin_r);
+        V c = select(odd, sin_r, cos_r);
+
+        // sin(r + n pi/2) is negated in quadrants 2 and 3 and cos(r + n pi/2) in quadrants 1 and 2
+        typename V::mask negate_sin = (q == two) | (q == neg_two) | (q == neg_one);
+        typename V::mask negate_cos = (q == one) | (q == two) | (q == neg_two);
+        sin_x = select(negate_sin, zero - s, s);
+        cos_x = select(negate_cos, zero - c, c);
+    }
+
+    // exp(z) = exp(re z) (cos(im z) + i sin(im z)) for a batch of complex numbers
+    template<typename V>
+    void exp(std::complex<double> const* points, std::complex<double>* results, size_t count)
+    {
+        constexpr size_t width = V::width;
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* in = reinterpret_cast<double const*>(points);
+        double* out = reinterpret_cast<double*>(results);
+
+        alignas(64) double re[width];
+        alignas(64) double im[width];
+        for (size_t begin = 0; begin < count; begin += width)
+        {
+            size_t n = (count - begin < width) ? count - begin : width;
+            for (size_t lane = 0; lane < width; ++lane)
+            {
+                re[lane] = (lane < n) ? in[2 * (begin + lane)] : 0.0;
+                im[lane] = (lane < n) ? in[2 * (begin + lane) + 1] : 0.0;
+            }
+
+            V magnitude = exp(V::load(re));
+            V s, c;
+            sincos(V::load(im), s, c);
+            (magnitude * c).store(re);
+            (magnitude * s).store(im);
+
+            for (size_t lane = 0; lane < n; ++lane)
+            {
+                out[2 * (begin + lane)] = re[lane];
+                out[2 * (begin + lane) + 1] = im[lane];
+            }
+        }
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+#include "fractalgen/kernels/kernels.hpp"
+
+namespace fractalgen::kernels::impl
+{
+
+    /**
+     * Newton's method kernel written against a simd vector type V (see fractalgen/simd). Each lane runs its own
+     * point and lanes are refilled as they finish, like the escape-time kernels.
+     *
+     * One pass over the roots computes both the step f(z) / f'(z) = 1 / sum 1 / (z - r_k) and the capture test,
+     * since |z - r_k|^2 is needed for both. A lane finishes as soon as z is inside a capture disk or, after the step
+     * converges or cap steps have been taken, with whatever disk (if any) contains the final z.
+     *
+     * The lanes hold V::value_type (float or double), and points and roots are rounded to it.
+     */
+    template<typename V>
+    void newton(std::complex<double> const* points, int* results, size_t count, roots_t const& roots, int cap, double eps)
+    {
+        using real = typename V::value_type;
+        constexpr size_t width = V::width;
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* coords = reinterpret_cast<double const*>(points);
+
+        alignas(64) real zr[width];
+        alignas(64) real zi[width];
+        alignas(64) real iterations[width];
+        alignas(64) real last[width];               // 1 once the next capture test decides the lane
+        alignas(64) real captured[width];           // index of the capture disk containing z or -1
+        size_t indices[width];
+
+        size_t next = 0;
+
+        // load the next point into the lane -- returns false once the input is exhausted
+        auto refill = [&](size_t lane)
+        {
+            bool found = next < count;
+            if (found)
+            {
+                indices[lane] = next;
+                zr[lane] = static_cast<real>(coords[2 * next]);
+                zi[lane] = static_cast<real>(coords[2 * next + 1]);
+                ++next;
+            }
+            else
+            {
+                // an exhausted lane is parked at the origin
+                zr[lane] = 0;
+                zi[lane] = 0;
+            }
+            iterations[lane] = 0;
+            last[lane] = 0;
+            return found;
+        };
+
+        unsigned live = 0;
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            if (refill(lane)) { live |= 1u << lane; }
+        }
+
+        V const zero = V::broadcast(0.0);
+        V const one = V::broadcast(1.0);
+        V const limit = V::broadcast(static_cast<double>(cap));
+        V const eps_sq = V::broadcast(eps * eps);
+
+        V vzr = V::load(zr), vzi = V::load(zi);
+        V vn = V::load(iterations);
+        V vlast = V::load(last);
+
+        while (live != 0)
+        {
+            V sum_re = zero;
+            V sum_im = zero;
+            V vfound = zero - one;
+            for (size_t k = 0; k < roots.count; ++k)
+            {
+                V dx = vzr - V::broadcast(roots.re[k]);
+                V dy = vzi - V::broadcast(roots.im[k]);
+                V mag_sq = dx * dx + dy * dy;
+
+                // keep the lowest index disk that contains z
+                typename V::mask inside = (mag_sq <= V::broadcast(roots.radius_sq[k])) & (vfound < zero);
+                vfound = select(inside, V::broadcast(static_cast<double>(k)), vfound);
+
+                // one division per root -- dividing dx and dy separately is twice the cost
+                V inv = one / mag_sq;
+                sum_re = sum_re + dx * inv;
+                sum_im = sum_im - dy * inv;
+            }
+
+            unsigned done = ((vfound >= zero) | (vlast == one)).bits() & live;
+
+            // z = z - 1 / sum (a lane that is exactly on a root has been captured so its step is never used)
+            V mag_sq = sum_re * sum_re + sum_im * sum_im;
+            V prev_r = vzr;
+            V prev_i = vzi;
+            vzr = vzr - sum_re / mag_sq;
+            vzi = vzi + sum_im / mag_sq;
+            vn = vn + one;
+
+            V dr = vzr - prev_r;
+            V di = vzi - prev_i;
+            vlast = select(((dr * dr + di * di) <= eps_sq) | (vn >= limit), one, vlast);
+
+            if (done != 0)
+            {
+                vzr.store(zr); vzi.store(zi);
+                vn.store(iterations);
+                vlast.store(last);
+                vfound.store(captured);
+
+                for (size_t lane = 0; lane < width; ++lane)
+                {
+                    unsigned bit = 1u << lane;
+                    if ((done & bit) == 0) { continue; }
+
+                    results[indices[lane]] = static_cast<int>(captured[lane]);
+                    if (!refill(lane)) { live &= ~bit; }
+                }
+
+                vzr = V::load(zr); vzi = V::load(zi);
+                vn = V::load(iterations);
+                vlast = V::load(last);
+            }
+        }
+    }
+
+}
\ No newline at end of file
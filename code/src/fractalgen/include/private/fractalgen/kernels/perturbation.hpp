@@ -0,0 +1,470 @@
+#pragma once
+
+#include <cmath>
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+#include "fractalgen/kernels/kernels.hpp"
+#include "fractalgen/numbers/floatexp.hpp"
+
+// compiled once per instruction set -- see fractalgen/kernels/targets.hpp for what that allows
+namespace fractalgen::kernels::impl
+{
+
+    static constexpr int64_t c_max_shift = 4096;         // shifts beyond this over- or underflow any double
+
+    // the number of set bits in a lane mask
+    static uint64_t count_bits(unsigned bits)
+    {
+        uint64_t count = 0;
+        for (; bits != 0; bits &= bits - 1) { ++count; }
+        return count;
+    }
+
+    // the number of iterations the series approximation lets an offset of the given magnitude skip. skipping 1 is no
+    // better than iterating, so that comes out as 0 too
+    static size_t skippable(series_t const& series, double magnitude)
+    {
+        // the radii never increase, so search for the number of entries the magnitude is below
+        size_t low = 0;
+        size_t high = series.length;
+        while (low < high)
+        {
+            size_t mid = (low + high) / 2;
+            if (magnitude < series.radius[mid]) { low = mid + 1; }
+            else { high = mid; }
+        }
+        return (low > 2) ? low - 1 : 0;
+    }
+
+    // the first iteration at which brent's method saves z after starting at iteration n (a power of two above n)
+    static double first_save(size_t n)
+    {
+        double save_at = 1.0;
+        while (save_at <= static_cast<double>(n)) { save_at += save_at; }
+        return save_at;
+    }
+
+    /**
+     * Perturbation kernel for the mandelbrot set written against a simd vector type V (see fractalgen/simd). Each
+     * point c = C + dc is iterated as its difference d_n = z_n - Z_n from the reference orbit Z_n of C, which only
+     * involves the small offsets: d_n+1 = (2 Z_n + d_n) d_n + dc. The reference orbit is read with a gather since
+     * lanes drift apart in how far along the reference they are.
+     *
+     * Whenever |z_n| < |d_n| the difference has become larger than the value it tracks and would lose all precision
+     * (a "glitch"), so the lane is rebased: d = z and it continues from Z_0 = 0, which is still a reference orbit of
+     * C. The same rebase lets a point keep going once it runs off the end of a reference that escaped.
+     *
+     * Each point starts where the series approximation leaves it. Until d is within a rounding error of Z it is a
+     * linear function of dc (the d^2 term is lost to rounding anyway), so that stretch is a single multiply.
+     *
+     * Escape, periodicity, and the distance estimate all use the full z = Z + d exactly like the mandelbrot kernel.
+     * There are no interior tests since c itself is not known to double precision. Returns how many points were
+     * rebased (after a glitch and at the end of the reference) and how many iterations the series approximation
+     * skipped.
+     */
+    template<typename V, bool estimate>
+    perturbed_t perturbation(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int cap, double tolerance)
+    {
+        constexpr size_t width = V::width;
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* coords = reinterpret_cast<double const*>(offsets);
+
+        alignas(64) double cr[width];               // dc
+        alignas(64) double ci[width];
+        alignas(64) double pr[width];               // d
+        alignas(64) double pi[width];
+        alignas(64) double ref_r[width];            // Z at the reference index
+        alignas(64) double ref_i[width];
+        alignas(64) double position[width];         // reference index
+        alignas(64) double sr[width];               // saved z for periodicity checking
+        alignas(64) double si[width];
+        alignas(64) double save_at[width];          // iteration at which z is next saved
+        alignas(64) double iterations[width];
+        alignas(64) double dr[width];               // dz/dc (only iterated when estimating distances)
+        alignas(64) double di[width];
+        size_t indices[width];
+
+        size_t next = 0;
+        perturbed_t counts;
+
+        // load the next point into the lane -- returns false once the input is exhausted
+        auto refill = [&](size_t lane)
+        {
+            bool found = next < count;
+            if (found)
+            {
+                indices[lane] = next;
+                cr[lane] = coords[2 * next];
+                ci[lane] = coords[2 * next + 1];
+                ++next;
+            }
+            else
+            {
+                // an exhausted lane is parked on the reference itself
+                cr[lane] = 0.0;
+                ci[lane] = 0.0;
+            }
+            pr[lane] = 0.0; pi[lane] = 0.0;
+            ref_r[lane] = 0.0; ref_i[lane] = 0.0;
+            position[lane] = 0.0;
+            sr[lane] = 0.0; si[lane] = 0.0;
+            save_at[lane] = 1.0;
+            iterations[lane] = 0.0;
+            dr[lane] = 0.0; di[lane] = 0.0;
+
+            // start from the series approximation as far as it reaches: d_s = coefficient_s dc and dz_s/dc = coefficient_s
+            size_t skip = found ? skippable(series, std::hypot(cr[lane], ci[lane])) : 0;
+            if (skip != 0)
+            {
+                int shift = static_cast<int>(series.exponent[skip]);
+                pr[lane] = std::ldexp(series.re[skip] * cr[lane] - series.im[skip] * ci[lane], shift);
+                pi[lane] = std::ldexp(series.re[skip] * ci[lane] + series.im[skip] * cr[lane], shift);
+                ref_r[lane] = orbit.re[skip]; ref_i[lane] = orbit.im[skip];
+                position[lane] = static_cast<double>(skip);
+                save_at[lane] = first_save(skip);
+                iterations[lane] = static_cast<double>(skip);
+                dr[lane] = std::ldexp(series.re[skip], shift); di[lane] = std::ldexp(series.im[skip], shift);
+                counts.approximated += skip;
+            }
+            return found;
+        };
+
+        unsigned live = 0;
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            if (refill(lane)) { live |= 1u << lane; }
+        }
+
+        V const zero = V::broadcast(0.0);
+        V const one = V::broadcast(1.0);
+        V const four = V::broadcast(4.0);
+        V const limit = V::broadcast(static_cast<double>(cap));
+        V const end = V::broadcast(static_cast<double>(orbit.length - 1));
+        V const tolerance_sq = V::broadcast(tolerance * tolerance);
+
+        V vcr = V::load(cr), vci = V::load(ci);
+        V vpr = V::load(pr), vpi = V::load(pi);
+        V vref_r = V::load(ref_r), vref_i = V::load(ref_i);
+        V vposition = V::load(position);
+        V vsr = V::load(sr), vsi = V::load(si);
+        V vsave_at = V::load(save_at);
+        V vn = V::load(iterations);
+        V vdr = V::load(dr), vdi = V::load(di);
+
+        while (live != 0)
+        {
+            // dz = 2 z dz + 1 (using z before it is updated)
+            if constexpr (estimate)
+            {
+                V zr = vref_r + vpr;
+                V zi = vref_i + vpi;
+                V re = zr * vdr - zi * vdi;
+                V im = zr * vdi + zi * vdr;
+                vdr = (re + re) + one;
+                vdi = im + im;
+            }
+
+            // d = (2 Z + d) d + dc
+            V tr = (vref_r + vref_r) + vpr;
+            V ti = (vref_i + vref_i) + vpi;
+            V re = (tr * vpr - ti * vpi) + vcr;
+            vpi = (tr * vpi + ti * vpr) + vci;
+            vpr = re;
+            vposition = vposition + one;
+            vn = vn + one;
+
+            vref_r = gather(orbit.re, vposition);
+            vref_i = gather(orbit.im, vposition);
+            V zr = vref_r + vpr;
+            V zi = vref_i + vpi;
+            V mag_sq = zr * zr + zi * zi;
+
+            // compare squared magnitudes so there is no sqrt in the loop
+            typename V::mask escaped = mag_sq > four;
+
+            // rebase onto Z_0 = 0 before the difference swamps z or the reference runs out
+            typename V::mask glitched = mag_sq < vpr * vpr + vpi * vpi;
+            typename V::mask rebase = glitched | (vposition >= end);
+            counts.glitched += count_bits(glitched.bits() & live);
+            counts.overrun += count_bits(rebase.bits() & ~glitched.bits() & live);
+            vpr = select(rebase, zr, vpr);
+            vpi = select(rebase, zi, vpi);
+            vref_r = select(rebase, zero, vref_r);
+            vref_i = select(rebase, zero, vref_i);
+            vposition = select(rebase, zero, vposition);
+
+            // compare against the saved value before (possibly) saving the current one
+            V er = zr - vsr;
+            V ei = zi - vsi;
+            typename V::mask periodic = (er * er + ei * ei) < tolerance_sq;
+            typename V::mask save = vn == vsave_at;
+            vsr = select(save, zr, vsr);
+            vsi = select(save, zi, vsi);
+            vsave_at = select(save, vsave_at + vsave_at, vsave_at);
+
+            unsigned done = (escaped | periodic | (vn >= limit)).bits() & live;
+            if (done != 0)
+            {
+                vcr.store(cr); vci.store(ci);
+                vpr.store(pr); vpi.store(pi);
+                vref_r.store(ref_r); vref_i.store(ref_i);
+                vposition.store(position);
+                vsr.store(sr); vsi.store(si);
+                vsave_at.store(save_at);
+                vn.store(iterations);
+                vdr.store(dr); vdi.store(di);
+
+                alignas(64) double mr[width];
+                alignas(64) double mi[width];
+                zr.store(mr); zi.store(mi);
+
+                unsigned escaped_bits = escaped.bits();
+                for (size_t lane = 0; lane < width; ++lane)
+                {
+                    unsigned bit = 1u << lane;
+                    if ((done & bit) == 0) { continue; }
+
+                    bool bounded = (escaped_bits & bit) == 0;
+                    results[indices[lane]] = { static_cast<int>(iterations[lane]), bounded };
+                    if constexpr (estimate)
+                    {
+                        double mag = std::sqrt(mr[lane] * mr[lane] + mi[lane] * mi[lane]);
+                        // |dz/dc| grows like the inverse of the zoom, so its square would overflow past about 1e-154
+                        double deriv = std::hypot(dr[lane], di[lane]);
+                        double distance = mag * std::log(mag) / deriv;
+                        if (bounded) { distance = iterations[lane] < cap ? 0.0 : NAN; }
+                        distances[indices[lane]] = distance;
+                    }
+                    if (!refill(lane)) { live &= ~bit; }
+                }
+
+                vcr = V::load(cr); vci = V::load(ci);
+                vpr = V::load(pr); vpi = V::load(pi);
+                vref_r = V::load(ref_r); vref_i = V::load(ref_i);
+                vposition = V::load(position);
+                vsr = V::load(sr); vsi = V::load(si);
+                vsave_at = V::load(save_at);
+                vn = V::load(iterations);
+                vdr = V::load(dr); vdi = V::load(di);
+            }
+        }
+        return counts;
+    }
+
+    /**
+     * The perturbation kernel for offsets given in units of 2^exponent, for zooms so deep that the offsets (and the
+     * differences d while they are that small) would underflow a double. dc, d, and dz/dc are kept as mantissas with an
+     * exponent (see numbers::complex_floatexp) while z = Z + d, which is never small for long, stays a double -- d only
+     * contributes to z once it has grown into the range of double.
+     *
+     * Scaling by powers of two is exact, so where nothing underflows this gives exactly the results of the plain kernel.
+     * The distances are in units of 2^exponent as well.
+     */
+    template<typename V, bool estimate>
+    perturbed_t perturbation_scaled(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int64_t exponent, int cap, double tolerance)
+    {
+        using complex = numbers::complex_floatexp<V>;
+        constexpr size_t width = V::width;
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* coords = reinterpret_cast<double const*>(offsets);
+
+        alignas(64) double cr[width];               // dc
+        alignas(64) double ci[width];
+        alignas(64) double ce[width];
+        alignas(64) double pr[width];               // d
+        alignas(64) double pi[width];
+        alignas(64) double pe[width];
+        alignas(64) double ref_r[width];            // Z at the reference index
+        alignas(64) double ref_i[width];
+        alignas(64) double position[width];         // reference index
+        alignas(64) double sr[width];               // saved z for periodicity checking
+        alignas(64) double si[width];
+        alignas(64) double save_at[width];          // iteration at which z is next saved
+        alignas(64) double iterations[width];
+        alignas(64) double dr[width];               // dz/dc (only iterated when estimating distances)
+        alignas(64) double di[width];
+        alignas(64) double de[width];
+        size_t indices[width];
+
+        size_t next = 0;
+        perturbed_t counts;
+
+        // load the next point into the lane -- returns false once the input is exhausted. dc, d, and dz/dc are
+        // normalized once the lanes are loaded again
+        auto refill = [&](size_t lane)
+        {
+            bool found = next < count;
+            if (found)
+            {
+                indices[lane] = next;
+                cr[lane] = coords[2 * next];
+                ci[lane] = coords[2 * next + 1];
+                ++next;
+            }
+            else
+            {
+                // an exhausted lane is parked on the reference itself
+                cr[lane] = 0.0;
+                ci[lane] = 0.0;
+            }
+            ce[lane] = static_cast<double>(exponent);
+            pr[lane] = 0.0; pi[lane] = 0.0; pe[lane] = numbers::c_floatexp_zero;
+            ref_r[lane] = 0.0; ref_i[lane] = 0.0;
+            position[lane] = 0.0;
+            sr[lane] = 0.0; si[lane] = 0.0;
+            save_at[lane] = 1.0;
+            iterations[lane] = 0.0;
+            dr[lane] = 0.0; di[lane] = 0.0; de[lane] = numbers::c_floatexp_zero;
+
+            // start from the series approximation as far as it reaches: d_s = coefficient_s dc and dz_s/dc = coefficient_s
+            size_t skip = found ? skippable(series, std::hypot(cr[lane], ci[lane])) : 0;
+            if (skip != 0)
+            {
+                double shift = static_cast<double>(series.exponent[skip]);
+                pr[lane] = series.re[skip] * cr[lane] - series.im[skip] * ci[lane];
+                pi[lane] = series.re[skip] * ci[lane] + series.im[skip] * cr[lane];
+                pe[lane] = ce[lane] + shift;
+                ref_r[lane] = orbit.re[skip]; ref_i[lane] = orbit.im[skip];
+                position[lane] = static_cast<double>(skip);
+                save_at[lane] = first_save(skip);
+                iterations[lane] = static_cast<double>(skip);
+                dr[lane] = series.re[skip]; di[lane] = series.im[skip]; de[lane] = shift;
+                counts.approximated += skip;
+            }
+            return found;
+        };
+
+        unsigned live = 0;
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            if (refill(lane)) { live |= 1u << lane; }
+        }
+
+        V const zero = V::broadcast(0.0);
+        V const four = V::broadcast(4.0);
+        V const one = V::broadcast(1.0);
+        V const limit = V::broadcast(static_cast<double>(cap));
+        V const end = V::broadcast(static_cast<double>(orbit.length - 1));
+        V const tolerance_sq = V::broadcast(tolerance * tolerance);
+        complex const unit = { one, zero, zero };
+
+        complex c = complex{ V::load(cr), V::load(ci), V::load(ce) }.normalized();
+        complex d = complex{ V::load(pr), V::load(pi), V::load(pe) }.normalized();
+        V vref_r = V::load(ref_r), vref_i = V::load(ref_i);
+        V vposition = V::load(position);
+        V vsr = V::load(sr), vsi = V::load(si);
+        V vsave_at = V::load(save_at);
+        V vn = V::load(iterations);
+        complex deriv = complex{ V::load(dr), V::load(di), V::load(de) }.normalized();
+
+        while (live != 0)
+        {
+            // d in double precision (0 while it is too small to matter next to Z)
+            V xr, xi;
+            d.to_double(xr, xi);
+
+            // dz = 2 z dz + 1 (using z before it is updated)
+            if constexpr (estimate)
+            {
+                V zr = vref_r + xr;
+                V zi = vref_i + xi;
+                deriv = deriv.times(zr + zr, zi + zi) + unit;
+            }
+
+            // d = (2 Z + d) d + dc
+            V tr = (vref_r + vref_r) + xr;
+            V ti = (vref_i + vref_i) + xi;
+            d = d.times(tr, ti) + c;
+            vposition = vposition + one;
+            vn = vn + one;
+
+            d.to_double(xr, xi);
+            vref_r = gather(orbit.re, vposition);
+            vref_i = gather(orbit.im, vposition);
+            V zr = vref_r + xr;
+            V zi = vref_i + xi;
+            V mag_sq = zr * zr + zi * zi;
+
+            // compare squared magnitudes so there is no sqrt in the loop
+            typename V::mask escaped = mag_sq > four;
+
+            // rebase onto Z_0 = 0 before the difference swamps z or the reference runs out
+            typename V::mask glitched = mag_sq < xr * xr + xi * xi;
+            typename V::mask rebase = glitched | (vposition >= end);
+            counts.glitched += count_bits(glitched.bits() & live);
+            counts.overrun += count_bits(rebase.bits() & ~glitched.bits() & live);
+            complex rebased = complex{ zr, zi, zero }.normalized();
+            d.re = select(rebase, rebased.re, d.re);
+            d.im = select(rebase, rebased.im, d.im);
+            d.exponent = select(rebase, rebased.exponent, d.exponent);
+            vref_r = select(rebase, zero, vref_r);
+            vref_i = select(rebase, zero, vref_i);
+            vposition = select(rebase, zero, vposition);
+
+            // compare against the saved value before (possibly) saving the current one
+            V er = zr - vsr;
+            V ei = zi - vsi;
+            typename V::mask periodic = (er * er + ei * ei) < tolerance_sq;
+            typename V::mask save = vn == vsave_at;
+            vsr = select(save, zr, vsr);
+            vsi = select(save, zi, vsi);
+            vsave_at = select(save, vsave_at + vsave_at, vsave_at);
+
+            unsigned done = (escaped | periodic | (vn >= limit)).bits() & live;
+            if (done != 0)
+            {
+                c.re.store(cr); c.im.store(ci); c.exponent.store(ce);
+                d.re.store(pr); d.im.store(pi); d.exponent.store(pe);
+                vref_r.store(ref_r); vref_i.store(ref_i);
+                vposition.store(position);
+                vsr.store(sr); vsi.store(si);
+                vsave_at.store(save_at);
+                vn.store(iterations);
+                deriv.re.store(dr); deriv.im.store(di); deriv.exponent.store(de);
+
+                alignas(64) double mr[width];
+                alignas(64) double mi[width];
+                zr.store(mr); zi.store(mi);
+
+                unsigned escaped_bits = escaped.bits();
+                for (size_t lane = 0; lane < width; ++lane)
+                {
+                    unsigned bit = 1u << lane;
+                    if ((done & bit) == 0) { continue; }
+
+                    bool bounded = (escaped_bits & bit) == 0;
+                    results[indices[lane]] = { static_cast<int>(iterations[lane]), bounded };
+                    if constexpr (estimate)
+                    {
+                        // |z| log|z| / |dz/dc| with the exponents of dz/dc and the units taken out. the shift is clamped
+                        // to a range past which ldexp saturates anyway
+                        double mag = std::sqrt(mr[lane] * mr[lane] + mi[lane] * mi[lane]);
+                        double mantissa = std::hypot(dr[lane], di[lane]);
+                        int64_t shift = -(static_cast<int64_t>(de[lane]) + exponent);
+                        shift = (shift < -c_max_shift) ? -c_max_shift : (shift > c_max_shift) ? c_max_shift : shift;
+                        double distance = std::ldexp(mag * std::log(mag) / mantissa, static_cast<int>(shift));
+                        if (bounded) { distance = iterations[lane] < cap ? 0.0 : NAN; }
+                        distances[indices[lane]] = distance;
+                    }
+                    if (!refill(lane)) { live &= ~bit; }
+                }
+
+                c = complex{ V::load(cr), V::load(ci), V::load(ce) }.normalized();
+                d = complex{ V::load(pr), V::load(pi), V::load(pe) }.normalized();
+                vref_r = V::load(ref_r); vref_i = V::load(ref_i);
+                vposition = V::load(position);
+                vsr = V::load(sr); vsi = V::load(si);
+                vsave_at = V::load(save_at);
+                vn = V::load(iterations);
+                deriv = complex{ V::load(dr), V::load(di), V::load(de) }.normalized();
+            }
+        }
+        return counts;
+    }
+
+}
\ No newline at end of file
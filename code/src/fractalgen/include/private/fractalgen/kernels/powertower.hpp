@@ -0,0 +1,140 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+#include "fractalgen/kernels/kernels.hpp"
+#include "fractalgen/kernels/math.hpp"
+
+// compiled once per instruction set -- see fractalgen/kernels/targets.hpp for what that allows
+namespace fractalgen::kernels::impl
+{
+
+    /**
+     * Escape-time kernel for z_n+1 = num^z_n = exp(z_n log(num)) with z_0 = num, written against a simd vector type V
+     * (see fractalgen/simd). Lanes are refilled as they finish, exactly like the mandelbrot kernel, and periodicity
+     * is detected with the same Brent's method.
+     *
+     * Since |z| < magnitude and |log(num)| < 750 for every finite num, the arguments to exp and sincos stay well inside
+     * the ranges where the approximations in fractalgen/kernels/math.hpp are accurate. With float lanes exp saturates
+     * far beyond the magnitude cap (which still escapes) and sincos loses accuracy on the rare towers with |z| |log(num)|
+     * above 8192 -- float is only chosen for views too coarse to resolve the difference anyway.
+     *
+     * Every point is iterated -- the ones that are classified up front have already been filtered out (see
+     * kernels::powertower) and each point comes with its log. The result for points[k] is written to
+     * results[positions[k]]. The lanes hold V::value_type (float or double), and num and log(num) are rounded to it.
+     */
+    template<typename V>
+    void powertower(std::complex<double> const* points, std::complex<double> const* logs, size_t const* positions, escape_t* results, size_t count, int cap, double magnitude, double tolerance)
+    {
+        using real = typename V::value_type;
+        constexpr size_t width = V::width;
+
+        double magnitude_sq = magnitude * magnitude;
+
+        alignas(64) real lr[width];                 // log(num)
+        alignas(64) real li[width];
+        alignas(64) real zr[width];
+        alignas(64) real zi[width];
+        alignas(64) real sr[width];                 // saved z for periodicity checking
+        alignas(64) real si[width];
+        alignas(64) real save_at[width];            // iteration at which z is next saved
+        alignas(64) real iterations[width];
+        size_t indices[width];
+
+        // std::complex<double> is guaranteed to be layout compatible with double[2]
+        double const* coords = reinterpret_cast<double const*>(points);
+        double const* log_coords = reinterpret_cast<double const*>(logs);
+
+        size_t next = 0;
+
+        // load the next point into the lane -- returns false once the input is exhausted
+        auto refill = [&](size_t lane)
+        {
+            // an exhausted lane is parked at num = 1 where z stays at 1 forever
+            bool found = next < count;
+            double x = 1.0, y = 0.0, lx = 0.0, ly = 0.0;
+            if (found)
+            {
+                indices[lane] = positions[next];
+                x = coords[2 * next]; y = coords[2 * next + 1];
+                lx = log_coords[2 * next]; ly = log_coords[2 * next + 1];
+                ++next;
+            }
+            lr[lane] = static_cast<real>(lx); li[lane] = static_cast<real>(ly);
+            zr[lane] = static_cast<real>(x); zi[lane] = static_cast<real>(y);
+            sr[lane] = zr[lane]; si[lane] = zi[lane];
+            save_at[lane] = 1;
+            iterations[lane] = 0;
+            return found;
+        };
+
+        unsigned live = 0;
+        for (size_t lane = 0; lane < width; ++lane)
+        {
+            if (refill(lane)) { live |= 1u << lane; }
+        }
+
+        V const one = V::broadcast(1.0);
+        V const limit = V::broadcast(static_cast<double>(cap));
+        V const escape_sq = V::broadcast(magnitude_sq);
+        V const tolerance_sq = V::broadcast(tolerance * tolerance);
+
+        V vlr = V::load(lr), vli = V::load(li);
+        V vzr = V::load(zr), vzi = V::load(zi);
+        V vsr = V::load(sr), vsi = V::load(si);
+        V vsave_at = V::load(save_at);
+        V vn = V::load(iterations);
+
+        while (live != 0)
+        {
+            // z = exp(z * log(num)) = exp(a) (cos(b) + i sin(b))
+            V a = vzr * vlr - vzi * vli;
+            V b = vzr * vli + vzi * vlr;
+            V scale = exp(a);
+            V s, c;
+            sincos(b, s, c);
+            vzr = scale * c;
+            vzi = scale * s;
+            vn = vn + one;
+
+            typename V::mask escaped = (vzr * vzr + vzi * vzi) >= escape_sq;
+
+            // compare against the saved value before (possibly) saving the current one
+            V dr = vzr - vsr;
+            V di = vzi - vsi;
+            typename V::mask periodic = (dr * dr + di * di) < tolerance_sq;
+            typename V::mask save = vn == vsave_at;
+            vsr = select(save, vzr, vsr);
+            vsi = select(save, vzi, vsi);
+            vsave_at = select(save, vsave_at + vsave_at, vsave_at);
+
+            unsigned done = (escaped | periodic | (vn >= limit)).bits() & live;
+            if (done != 0)
+            {
+                vlr.store(lr); vli.store(li);
+                vzr.store(zr); vzi.store(zi);
+                vsr.store(sr); vsi.store(si);
+                vsave_at.store(save_at);
+                vn.store(iterations);
+
+                unsigned escaped_bits = escaped.bits();
+                for (size_t lane = 0; lane < width; ++lane)
+                {
+                    unsigned bit = 1u << lane;
+                    if ((done & bit) == 0) { continue; }
+
+                    results[indices[lane]] = { static_cast<int>(iterations[lane]), (escaped_bits & bit) == 0 };
+                    if (!refill(lane)) { live &= ~bit; }
+                }
+
+                vlr = V::load(lr); vli = V::load(li);
+                vzr = V::load(zr); vzi = V::load(zi);
+                vsr = V::load(sr); vsi = V::load(si);
+                vsave_at = V::load(save_at);
+                vn = V::load(iterations);
+            }
+        }
+    }
+
+}
\ No newline at end of file
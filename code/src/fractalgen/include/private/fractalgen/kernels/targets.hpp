@@ -0,0 +1,54 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+#include "fractalgen/kernels/kernels.hpp"
+
+/**
+ * Entry points of the kernels compiled for each instruction set. Each set is defined in its own translation unit
+ * (compiled with the matching target flags) and the templates are instantiated there for T = float and T = double,
+ * the type the lanes hold.
+ *
+ * Any inline function those translation units emit that the generic ones emit too (a non-template helper, or an
+ * instantiation of std::complex, <bit>, or <limits> code) is one symbol to the linker, which may keep the copy built
+ * with target flags and run it on a cpu without them. So the kernel headers give helpers internal linkage or make
+ * them templates on the vector type, and only use library code that is not inline: the entry points take plain
+ * pointers, points are read as pairs of doubles, and anything that needs std::complex is done in kernels.cpp
+ * before dispatching.
+ */
+
+namespace fractalgen::kernels::scalar
+{
+    template<typename T> void mandelbrot(std::complex<double> const* points, escape_t* results, double* distances, size_t count, int cap, double tolerance);
+    perturbed_t perturbation(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int cap, double tolerance);
+    perturbed_t perturbation_scaled(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int64_t exponent, int cap, double tolerance);
+    template<typename T> void powertower(std::complex<double> const* points, std::complex<double> const* logs, size_t const* positions, escape_t* results, size_t count, int cap, double magnitude, double tolerance);
+    void exp(std::complex<double> const* points, std::complex<double>* results, size_t count);
+    template<typename T> void newton(std::complex<double> const* points, int* results, size_t count, roots_t const& roots, int cap, double eps);
+}
+
+#if defined(FRACTALGEN_SIMD_X86)
+
+namespace fractalgen::kernels::avx2
+{
+    template<typename T> void mandelbrot(std::complex<double> const* points, escape_t* results, double* distances, size_t count, int cap, double tolerance);
+    perturbed_t perturbation(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int cap, double tolerance);
+    perturbed_t perturbation_scaled(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int64_t exponent, int cap, double tolerance);
+    template<typename T> void powertower(std::complex<double> const* points, std::complex<double> const* logs, size_t const* positions, escape_t* results, size_t count, int cap, double magnitude, double tolerance);
+    void exp(std::complex<double> const* points, std::complex<double>* results, size_t count);
+    template<typename T> void newton(std::complex<double> const* points, int* results, size_t count, roots_t const& roots, int cap, double eps);
+}
+
+namespace fractalgen::kernels::avx512
+{
+    template<typename T> void mandelbrot(std::complex<double> const* points, escape_t* results, double* distances, size_t count, int cap, double tolerance);
+    perturbed_t perturbation(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int cap, double tolerance);
+    perturbed_t perturbation_scaled(std::complex<double> const* offsets, escape_t* results, double* distances, size_t count, orbit_t const& orbit, series_t const& series, int64_t exponent, int cap, double tolerance);
+    template<typename T> void powertower(std::complex<double> const* points, std::complex<double> const* logs, size_t const* positions, escape_t* results, size_t count, int cap, double magnitude, double tolerance);
+    void exp(std::complex<double> const* points, std::complex<double>* results, size_t count);
+    template<typename T> void newton(std::complex<double> const* points, int* results, size_t count, roots_t const& roots, int cap, double eps);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <optional>
+#include <string_view>
+
+namespace fractalgen::numbers
+{
+
+    // the full 128 bit product a * b -- returns the low half and writes the high half
+    inline uint64_t mul_wide(uint64_t a, uint64_t b, uint64_t& high)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        high = static_cast<uint64_t>(product >> 64);
+        return static_cast<uint64_t>(product);
+#else
+        // schoolbook multiplication on 32 bit halves
+        uint64_t a_lo = a & 0xffffffff;
+        uint64_t a_hi = a >> 32;
+        uint64_t b_lo = b & 0xffffffff;
+        uint64_t b_hi = b >> 32;
+        uint64_t ll = a_lo * b_lo;
+        uint64_t lh = a_lo * b_hi;
+        uint64_t hl = a_hi * b_lo;
+        uint64_t mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+        high = a_hi * b_hi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return (mid << 32) | (ll & 0xffffffff);
+#endif
+    }
+
+    /**
+     * A binary floating point number with N 64 bit limbs of mantissa, for coordinates and reference orbits that need
+     * more precision than a double. The value is (-1)^negative * 0.m * 2^exponent with the mantissa m normalized so its
+     * top bit is set (zero has an all zero mantissa). Everything is stored inline so arithmetic never allocates.
+     *
+     * Results are truncated instead of rounded, so each operation is off by at most a unit or two in the last limb.
+     */
+    template<size_t N>
+    class bigfloat
+    {
+    public:
+
+        static_assert(N > 0);
+
+        static constexpr size_t limbs = N;
+        static constexpr size_t bits = 64 * N;
+
+        bigfloat() = default;
+
+        // exact since a double's mantissa fits in the top limb. infinities and nans become 0
+        explicit bigfloat(double x)
+        {
+            if (x == 0.0 || !std::isfinite(x)) { return; }
+
+            int exponent;
+            double fraction = std::frexp(std::abs(x), &exponent);                  // in [1/2, 1)
+            m_mantissa[N - 1] = static_cast<uint64_t>(std::ldexp(fraction, 64));
+            m_exponent = exponent;
+            m_negative = x < 0.0;
+        }
+
+        // change the number of limbs, truncating or zero extending the mantissa
+        template<size_t M>
+        explicit bigfloat(bigfloat<M> const& other)
+            : m_exponent(other.m_exponent), m_negative(other.m_negative)
+        {
+            for (size_t k = 0; k < std::min(N, M); ++k) { m_mantissa[N - 1 - k] = other.m_mantissa[M - 1 - k]; }
+        }
+
+        // parse a decimal number like -0.74364388703715870475219150611477 or 1.5e-20. returns nullopt if any of the
+        // text is not part of the number
+        static std::optional<bigfloat> parse(std::string_view text)
+        {
+            size_t pos = 0;
+            bool negative = false;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) { negative = text[pos++] == '-'; }
+
+            // accumulate the digits as an integer and remember the power of ten it has to be scaled by
+            bigfloat const ten(10.0);
+            bigfloat value;
+            int64_t scale = 0;
+            size_t digits = 0;
+            bool point = false;
+            for (; pos < text.size(); ++pos)
+            {
+                char c = text[pos];
+                if (c == '.' && !point) { point = true; continue; }
+                if (c < '0' || c > '9') { break; }
+
+                value = value * ten + bigfloat(static_cast<double>(c - '0'));
+                if (point) { --scale; }
+                ++digits;
+            }
+            if (digits == 0) { return std::nullopt; }
+
+            if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+            {
+                ++pos;
+                if (pos < text.size() && text[pos] == '+') { ++pos; }
+
+                int64_t exponent = 0;
+                auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), exponent);
+                if (error != std::errc() || std::abs(exponent) > c_max_decimal_exponent) { return std::nullopt; }
+                pos = static_cast<size_t>(end - text.data());
+                scale += exponent;
+            }
+            if (pos != text.size()) { return std::nullopt; }
+
+            for (; scale > 0; --scale) { value = value * ten; }
+            for (; scale < 0; ++scale) { value.divide(10); }
+            value.m_negative = negative && !value.is_zero();
+            return value;
+        }
+
+        // round to the nearest double (values outside the range of double become 0 or infinity)
+        explicit operator double() const
+        {
+            if (is_zero()) { return 0.0; }
+
+            // the top limb already holds more bits than a double, so the rest of the mantissa is only a tie breaker
+            int64_t exponent = std::clamp<int64_t>(m_exponent - 64, -c_max_binary_exponent, c_max_binary_exponent);
+            double x = std::ldexp(static_cast<double>(m_mantissa[N - 1]), static_cast<int>(exponent));
+            return m_negative ? -x : x;
+        }
+
+        bool is_zero() const { return m_mantissa[N - 1] == 0; }
+        bool negative() const { return m_negative; }
+
+        // the value is in [2^(exponent - 1), 2^exponent) in magnitude
+        int64_t exponent() const { return m_exponent; }
+
+        // the value divided by 2^exponent rounded to double, in [1/2, 1] in magnitude (or 0). unlike the conversion to
+        // double this never underflows
+        double mantissa() const
+        {
+            double x = std::ldexp(static_cast<double>(m_mantissa[N - 1]), -64);
+            return m_negative ? -x : x;
+        }
+
+        bigfloat operator-() const
+        {
+            bigfloat result = *this;
+            result.m_negative = !m_negative && !is_zero();
+            return result;
+        }
+
+        friend bigfloat operator+(bigfloat const& lhs, bigfloat const& rhs) { return add(lhs, rhs, rhs.m_negative); }
+        friend bigfloat operator-(bigfloat const& lhs, bigfloat const& rhs) { return add(lhs, rhs, !rhs.m_negative); }
+
+        friend bigfloat operator*(bigfloat const& lhs, bigfloat const& rhs)
+        {
+            bigfloat result;
+            if (lhs.is_zero() || rhs.is_zero()) { return result; }
+
+            // only the limb products that land in the top N + 2 limbs of the full 2N limb product are accumulated. the
+            // ones that are skipped add up to less than one unit in the last limb of the result
+            constexpr size_t low = (N >= 2) ? N - 2 : 0;
+            std::array<uint64_t, 2 * N - low> sum = {};
+            for (size_t i = 0; i < N; ++i)
+            {
+                uint64_t carry = 0;
+                for (size_t j = (i >= low) ? 0 : low - i; j < N; ++j)
+                {
+                    uint64_t high;
+                    uint64_t product = mul_wide(lhs.m_mantissa[i], rhs.m_mantissa[j], high);
+
+                    // (high, product) + sum + carry fits in 128 bits
+                    uint64_t& limb = sum[i + j - low];
+                    limb += product;
+                    high += (limb < product) ? 1 : 0;
+                    limb += carry;
+                    high += (limb < carry) ? 1 : 0;
+                    carry = high;
+                }
+                sum[i + N - low] = carry;
+            }
+
+            // both mantissas are in [1/2, 1) so the product is in [1/4, 1) and needs at most one bit of normalization
+            constexpr size_t top = N - low;
+            bool shift = (sum[top + N - 1] >> 63) == 0;
+            for (size_t k = 0; k < N; ++k)
+            {
+                uint64_t limb = sum[top + k];
+                result.m_mantissa[k] = shift ? (limb << 1) | (sum[top + k - 1] >> 63) : limb;
+            }
+            result.m_exponent = lhs.m_exponent + rhs.m_exponent - (shift ? 1 : 0);
+            result.m_negative = lhs.m_negative != rhs.m_negative;
+            return result;
+        }
+
+        bigfloat& operator+=(bigfloat const& rhs) { return *this = *this + rhs; }
+        bigfloat& operator-=(bigfloat const& rhs) { return *this = *this - rhs; }
+        bigfloat& operator*=(bigfloat const& rhs) { return *this = *this * rhs; }
+
+    private:
+
+        template<size_t M> friend class bigfloat;
+
+        using mantissa_t = std::array<uint64_t, N>;
+
+        static constexpr int64_t c_max_decimal_exponent = 100000;
+        static constexpr int64_t c_max_binary_exponent = 1 << 20;
+
+        // least significant limb first
+        mantissa_t m_mantissa = {};
+        int64_t m_exponent = 0;
+        bool m_negative = false;
+
+        static mantissa_t shift_right(mantissa_t const& mantissa, size_t shift)
+        {
+            mantissa_t result = {};
+            size_t whole = shift / 64;
+            unsigned part = shift % 64;
+            for (size_t k = 0; k + whole < N; ++k)
+            {
+                size_t src = k + whole;
+                uint64_t above = (part != 0 && src + 1 < N) ? mantissa[src + 1] << (64 - part) : 0;
+                result[k] = (mantissa[src] >> part) | above;
+            }
+            return result;
+        }
+
+        static mantissa_t shift_left(mantissa_t const& mantissa, size_t shift)
+        {
+            mantissa_t result = {};
+            size_t whole = shift / 64;
+            unsigned part = shift % 64;
+            for (size_t k = whole; k < N; ++k)
+            {
+                size_t src = k - whole;
+                uint64_t below = (part != 0 && src > 0) ? mantissa[src - 1] >> (64 - part) : 0;
+                result[k] = (mantissa[src] << part) | below;
+            }
+            return result;
+        }
+
+        // compare |lhs| and |rhs| for nonzero numbers
+        static int compare_magnitude(bigfloat const& lhs, bigfloat const& rhs)
+        {
+            if (lhs.m_exponent != rhs.m_exponent) { return (lhs.m_exponent < rhs.m_exponent) ? -1 : 1; }
+            for (size_t k = N; k-- > 0;)
+            {
+                if (lhs.m_mantissa[k] != rhs.m_mantissa[k]) { return (lhs.m_mantissa[k] < rhs.m_mantissa[k]) ? -1 : 1; }
+            }
+            return 0;
+        }
+
+        // lhs + rhs where rhs takes the sign rhs_negative
+        static bigfloat add(bigfloat const& lhs, bigfloat const& rhs, bool rhs_negative)
+        {
+            if (rhs.is_zero()) { return lhs; }
+            if (lhs.is_zero())
+            {
+                bigfloat result = rhs;
+                result.m_negative = rhs_negative;
+                return result;
+            }
+
+            // the smaller magnitude is aligned to the larger one (and subtracted from it when the signs differ)
+            bool swap = compare_magnitude(lhs, rhs) < 0;
+            bigfloat const& large = swap ? rhs : lhs;
+            bigfloat const& small = swap ? lhs : rhs;
+
+            bigfloat result;
+            result.m_exponent = large.m_exponent;
+            result.m_negative = swap ? rhs_negative : lhs.m_negative;
+
+            uint64_t shift = static_cast<uint64_t>(large.m_exponent - small.m_exponent);
+            if (shift >= bits)
+            {
+                result.m_mantissa = large.m_mantissa;
+                return result;
+            }
+            mantissa_t aligned = shift_right(small.m_mantissa, shift);
+
+            if (lhs.m_negative == rhs_negative)
+            {
+                uint64_t carry = 0;
+                for (size_t k = 0; k < N; ++k)
+                {
+                    uint64_t limb = large.m_mantissa[k] + aligned[k];
+                    uint64_t overflow = (limb < aligned[k]) ? 1 : 0;
+                    limb += carry;
+                    overflow |= (limb < carry) ? 1 : 0;
+                    result.m_mantissa[k] = limb;
+                    carry = overflow;
+                }
+                if (carry != 0)
+                {
+                    result.m_mantissa = shift_right(result.m_mantissa, 1);
+                    result.m_mantissa[N - 1] |= uint64_t(1) << 63;
+                    ++result.m_exponent;
+                }
+            }
+            else
+            {
+                uint64_t borrow = 0;
+                for (size_t k = 0; k < N; ++k)
+                {
+                    uint64_t limb = large.m_mantissa[k] - aligned[k];
+                    uint64_t underflow = (large.m_mantissa[k] < aligned[k]) ? 1 : 0;
+                    underflow |= (limb < borrow) ? 1 : 0;
+                    result.m_mantissa[k] = limb - borrow;
+                    borrow = underflow;
+                }
+                result.normalize();
+            }
+            return result;
+        }
+
+        // shift the mantissa up until its top bit is set
+        void normalize()
+        {
+            size_t top = N;
+            while (top > 0 && m_mantissa[top - 1] == 0) { --top; }
+            if (top == 0)
+            {
+                m_exponent = 0;
+                m_negative = false;
+                return;
+            }
+
+            size_t shift = (N - top) * 64 + std::countl_zero(m_mantissa[top - 1]);
+            m_mantissa = shift_left(m_mantissa, shift);
+            m_exponent -= static_cast<int64_t>(shift);
+        }
+
+        // divide by a small integer, shifting the next bits of the quotient in as the result is normalized
+        void divide(uint32_t divisor)
+        {
+            if (is_zero()) { return; }
+
+            // long division on 32 bit halves so every partial dividend fits in 64 bits
+            uint64_t remainder = 0;
+            auto step = [&](uint64_t limb)
+            {
+                uint64_t high = (remainder << 32) | (limb >> 32);
+                uint64_t quotient = high / divisor;
+                remainder = high % divisor;
+                uint64_t low = (remainder << 32) | (limb & 0xffffffff);
+                quotient = (quotient << 32) | (low / divisor);
+                remainder = low % divisor;
+                return quotient;
+            };
+            for (size_t k = N; k-- > 0;) { m_mantissa[k] = step(m_mantissa[k]); }
+            uint64_t next = step(0);
+
+            // the top bit was set, so the quotient has at most 32 leading zeros
+            unsigned shift = std::countl_zero(m_mantissa[N - 1]);
+            m_mantissa = shift_left(m_mantissa, shift);
+            if (shift != 0) { m_mantissa[0] |= next >> (64 - shift); }
+            m_exponent -= shift;
+        }
+
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+
+namespace fractalgen::numbers
+{
+
+    /**
+     * A double mantissa with a separate exponent, for lengths like the pixel spacing of a deep zoom that are far outside
+     * the range of double. The value is mantissa * 2^exponent with |mantissa| in [1/2, 1) or 0.
+     */
+    struct floatexp
+    {
+        double mantissa = 0.0;
+        int64_t exponent = 0;
+
+        floatexp() = default;
+
+        floatexp(double _mantissa, int64_t _exponent)
+        {
+            if (_mantissa == 0.0 || !std::isfinite(_mantissa)) { return; }
+
+            int shift;
+            mantissa = std::frexp(_mantissa, &shift);
+            exponent = _exponent + shift;
+        }
+
+        explicit floatexp(double x) : floatexp(x, 0) {}
+
+        // the nearest double (values outside the range of double become 0 or infinity)
+        explicit operator double() const
+        {
+            return std::ldexp(mantissa, static_cast<int>(std::clamp<int64_t>(exponent, -c_max_exponent, c_max_exponent)));
+        }
+
+        friend floatexp operator*(floatexp const& lhs, floatexp const& rhs)
+        {
+            return floatexp(lhs.mantissa * rhs.mantissa, lhs.exponent + rhs.exponent);
+        }
+
+        friend floatexp operator+(floatexp const& lhs, floatexp const& rhs)
+        {
+            if (lhs.mantissa == 0.0) { return rhs; }
+            if (rhs.mantissa == 0.0) { return lhs; }
+
+            // align the smaller number to the larger one's exponent -- past 64 bits of difference it can't contribute
+            floatexp const& large = (lhs.exponent >= rhs.exponent) ? lhs : rhs;
+            floatexp const& small = (lhs.exponent >= rhs.exponent) ? rhs : lhs;
+            int64_t shift = std::min<int64_t>(large.exponent - small.exponent, 64);
+            return floatexp(large.mantissa + std::ldexp(small.mantissa, static_cast<int>(-shift)), large.exponent);
+        }
+
+    private:
+
+        static constexpr int64_t c_max_exponent = 1 << 20;
+
+    };
+
+    // the exponent of 0 in complex_floatexp -- far enough below any other that 0 never decides an alignment
+    static constexpr double c_floatexp_zero = -1e15;
+
+    /**
+     * A complex number (re + i im) * 2^exponent with one exponent shared by both parts, in the lanes of a simd vector
+     * type V (see fractalgen/simd). Exponents are whole numbers stored as doubles so every operation stays within the
+     * vector interface. Normalized numbers have the larger part in [1, 2) in magnitude or are 0 with exponent
+     * c_floatexp_zero.
+     *
+     * Scaling by a power of two is exact, so as long as nothing underflows these give exactly the same results as the
+     * corresponding double arithmetic.
+     */
+    template<typename V>
+    struct complex_floatexp
+    {
+        V re;
+        V im;
+        V exponent;
+
+        static complex_floatexp zero()
+        {
+            return { V::broadcast(0.0), V::broadcast(0.0), V::broadcast(c_floatexp_zero) };
+        }
+
+        // moves whatever exponent the parts have over to the shared exponent
+        complex_floatexp normalized() const
+        {
+            V const nil = V::broadcast(0.0);
+            V shift = max(ilogb(re), ilogb(im));
+            V scale = pow2(nil - shift);
+            typename V::mask vanished = (re == nil) & (im == nil);
+            return { re * scale, im * scale, select(vanished, V::broadcast(c_floatexp_zero), exponent + shift) };
+        }
+
+        // the value in double precision for values below 2^1023 -- 0 once it is too small for a normal double
+        void to_double(V& x, V& y) const
+        {
+            V const min_exponent = V::broadcast(-1022.0);
+            V scale = select(exponent < min_exponent, V::broadcast(0.0), pow2(max(exponent, min_exponent)));
+            x = re * scale;
+            y = im * scale;
+        }
+
+        friend complex_floatexp operator+(complex_floatexp const& lhs, complex_floatexp const& rhs)
+        {
+            // align both to the larger exponent. a number more than 1022 binades smaller can't contribute
+            V const min_shift = V::broadcast(-1022.0);
+            V exponent = max(lhs.exponent, rhs.exponent);
+            V lhs_scale = pow2(max(lhs.exponent - exponent, min_shift));
+            V rhs_scale = pow2(max(rhs.exponent - exponent, min_shift));
+            complex_floatexp sum = { lhs.re * lhs_scale + rhs.re * rhs_scale, lhs.im * lhs_scale + rhs.im * rhs_scale, exponent };
+            return sum.normalized();
+        }
+
+        // multiply by x + i y in double precision. the exponent is unchanged so the result is only normalized if
+        // |x + i y| is close to 1
+        complex_floatexp times(V x, V y) const
+        {
+            return { re * x - im * y, re * y + im * x, exponent };
+        }
+    };
+
+}
\ No newline at end of file
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "fractalgen/generators/factory.hpp"
 #include "fractalgen/generators/generators.hpp"
+#include "fractalgen/simd/isa.hpp"
 
 namespace fractalgen
 {
@@ -16,11 +21,17 @@ namespace fractalgen
         {
             std::array<uint8_t, 3> color = { 0, 0, 0 };
             std::array<uint8_t, 3> diverging = { 0, 100, 0 };
+            double period_tolerance = 1e-10;
+            int iterations = 0;                     // derived from the window
+            bool perturb = false;
 
-            void augment(generators::config& config) const
+            void augment(generators::config& config, generators::window_t const& window) const
             {
                 config.color = color;
                 config.diverging = diverging;
+                config.period_tolerance = period_tolerance;
+                config.iterations = generators::choose_iterations(iterations, perturb, window);
+                config.perturb = perturb;
             }
         };
 
@@ -28,11 +39,13 @@ namespace fractalgen
         {
             std::array<uint8_t, 3> color = { 0, 0, 0 };
             std::array<uint8_t, 3> diverging = { 255, 255, 0 };
+            double period_tolerance = 1e-10;
 
             void augment(generators::config& config) const
             {
                 config.color = color;
                 config.diverging = diverging;
+                config.period_tolerance = period_tolerance;
             }
         };
 
@@ -48,22 +61,80 @@ namespace fractalgen
             }
         };
 
+        struct recolor_opts
+        {
+            bool run = false;
+            std::string field;
+
+            // colors that replace the ones the field was rendered with -- only applied when set on the command line
+            bool has_color = false;
+            bool has_diverging = false;
+            std::array<uint8_t, 3> color = { 0, 0, 0 };
+            std::array<uint8_t, 3> diverging = { 0, 0, 0 };
+
+            using root_color = std::array<double, 4>;
+            std::vector<root_color> roots;
+
+            void augment(generators::config& config) const
+            {
+                if (has_color) { config.color = color; }
+                if (has_diverging) { config.diverging = diverging; }
+                for (root_color const& root : roots)
+                {
+                    size_t index = static_cast<size_t>(root[0]);
+                    if (index < config.roots.size()) { std::copy(root.begin() + 1, root.end(), config.roots[index].begin() + 2); }
+                }
+            }
+        };
+
+        struct batch_opts
+        {
+            bool run = false;
+            std::string jobs = "-";
+        };
+
+        struct benchmark_opts
+        {
+            bool run = false;
+            size_t samples = 1 << 20;
+        };
+
         generators::types type;
         std::string name = "fractal.png";
         std::array<double, 4> bounds = { -4, -1.5, 1.33, 1.5 };
         int width = 750;
+
+        // a view given by its center and width in the complex plane (as decimals of any precision) replaces the bounds
+        std::array<std::string, 2> center;
+        std::string scale;
+        int height = 0;                             // defaults to width
         double phi = 0.0;
+        int supersample = 4;
+        bool adaptive = false;
+        double threshold = 8.0;
+        double distance = 2.0;
+        bool subdivide = false;
+        bool progressive = false;
+        std::string preview;
+        std::string field;
+        size_t threads = 0;
+        simd::isa simd = simd::best();
+        generators::precision_t precision = generators::precision_t::automatic;
 
         mandelbrot_opts mandelbrot;
         powertower_opts powertower;
         newton_opts newton;
+        recolor_opts recolor;
+        batch_opts batch;
+        benchmark_opts benchmark;
 
         generators::config config() const
         {
             generators::config cfg(type, phi);
+            cfg.precision = precision;
             switch (type)
             {
-                case generators::types::mandelbrot: mandelbrot.augment(cfg); break;
+                case generators::types::mandelbrot: mandelbrot.augment(cfg, window()); break;
                 case generators::types::powertower: powertower.augment(cfg); break;
                 case generators::types::newton    : newton    .augment(cfg); break;
                 default: break;
@@ -71,9 +142,62 @@ namespace fractalgen
             return cfg;
         }
 
+        // jobs with the same geometry sample the same points and compute the same fields, so they only differ in how
+        // the fields are shaded. adaptive and subdivided renders choose their samples by color, so for those the
+        // colors are part of the geometry
+        std::string geometry() const
+        {
+            std::ostringstream stream;
+            stream << std::setprecision(17);
+            stream << static_cast<int>(type) << ' ' << phi << ' ' << width << ' ' << supersample;
+            for (double bound : bounds) { stream << ' ' << bound; }
+            stream << ' ' << center[0] << ' ' << center[1] << ' ' << scale << ' ' << height;
+            stream << ' ' << adaptive << ' ' << threshold << ' ' << distance << ' ' << subdivide << ' ' << static_cast<int>(precision);
+
+            bool by_color = adaptive || subdivide;
+            auto colors = [&](std::array<uint8_t, 3> const& rgb) { for (uint8_t c : rgb) { stream << ' ' << static_cast<int>(c); } };
+            switch (type)
+            {
+                case generators::types::mandelbrot:
+                    stream << ' ' << mandelbrot.period_tolerance << ' ' << mandelbrot.iterations << ' ' << mandelbrot.perturb;
+                    if (by_color) { colors(mandelbrot.color); colors(mandelbrot.diverging); }
+                    break;
+                case generators::types::powertower:
+                    stream << ' ' << powertower.period_tolerance;
+                    if (by_color) { colors(powertower.color); colors(powertower.diverging); }
+                    break;
+                case generators::types::newton:
+                    for (generators::config::root const& root : newton.roots)
+                    {
+                        stream << ' ' << root[0] << ' ' << root[1];
+                        if (by_color) { stream << ' ' << root[2] << ' ' << root[3] << ' ' << root[4]; }
+                    }
+                    if (by_color) { colors(newton.diverging); }
+                    break;
+                default: break;
+            }
+            return stream.str();
+        }
+
+        numbers::floatexp extent() const
+        {
+            generators::coordinate_t value = *generators::coordinate_t::parse(scale);
+            return numbers::floatexp(value.mantissa(), value.exponent());
+        }
+
         generators::window_t window() const
         {
-            return { stfd::aabb2(stfd::vec2(bounds[0], bounds[1]), stfd::vec2(bounds[2], bounds[3])), width };
+            // the center and scale were validated when they were parsed. the scale only needs its leading bits but may
+            // be far below the range of double
+            generators::window_t window = center[0].empty()
+                ? generators::window_t(stfd::aabb2(stfd::vec2(bounds[0], bounds[1]), stfd::vec2(bounds[2], bounds[3])), width, supersample)
+                : generators::window_t(*generators::coordinate_t::parse(center[0]), *generators::coordinate_t::parse(center[1]), extent(), width, (height > 0) ? height : width, supersample);
+            window.adaptive = adaptive;
+            window.threshold = threshold;
+            window.distance = distance;
+            window.subdivide = subdivide;
+            window.progressive = progressive;
+            return window;
         }
 
     };
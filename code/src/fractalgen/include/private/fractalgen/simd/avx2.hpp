@@ -0,0 +1,132 @@
+#pragma once
+
+#if !defined(__AVX2__)
+#error "fractalgen/simd/avx2.hpp must be compiled with AVX2 enabled"
+#endif
+
+#include <cstddef>
+#include <type_traits>
+
+#include <immintrin.h>
+
+namespace fractalgen::simd::avx2
+{
+
+    struct mask64
+    {
+        __m256d v;
+
+        unsigned bits() const { return static_cast<unsigned>(_mm256_movemask_pd(v)); }
+    };
+
+    inline mask64 operator|(mask64 lhs, mask64 rhs) { return { _mm256_or_pd(lhs.v, rhs.v) }; }
+    inline mask64 operator&(mask64 lhs, mask64 rhs) { return { _mm256_and_pd(lhs.v, rhs.v) }; }
+
+    struct f64
+    {
+        static constexpr size_t width = 4;
+        using mask = mask64;
+        using value_type = double;
+
+        __m256d v;
+
+        static f64 broadcast(double x) { return { _mm256_set1_pd(x) }; }
+        static f64 load(double const* src) { return { _mm256_loadu_pd(src) }; }
+        void store(double* dst) const { _mm256_storeu_pd(dst, v); }
+    };
+
+    inline f64 operator+(f64 lhs, f64 rhs) { return { _mm256_add_pd(lhs.v, rhs.v) }; }
+    inline f64 operator-(f64 lhs, f64 rhs) { return { _mm256_sub_pd(lhs.v, rhs.v) }; }
+    inline f64 operator*(f64 lhs, f64 rhs) { return { _mm256_mul_pd(lhs.v, rhs.v) }; }
+    inline f64 operator/(f64 lhs, f64 rhs) { return { _mm256_div_pd(lhs.v, rhs.v) }; }
+
+    inline mask64 operator<(f64 lhs, f64 rhs) { return { _mm256_cmp_pd(lhs.v, rhs.v, _CMP_LT_OQ) }; }
+    inline mask64 operator<=(f64 lhs, f64 rhs) { return { _mm256_cmp_pd(lhs.v, rhs.v, _CMP_LE_OQ) }; }
+    inline mask64 operator>(f64 lhs, f64 rhs) { return { _mm256_cmp_pd(lhs.v, rhs.v, _CMP_GT_OQ) }; }
+    inline mask64 operator>=(f64 lhs, f64 rhs) { return { _mm256_cmp_pd(lhs.v, rhs.v, _CMP_GE_OQ) }; }
+    inline mask64 operator==(f64 lhs, f64 rhs) { return { _mm256_cmp_pd(lhs.v, rhs.v, _CMP_EQ_OQ) }; }
+
+    // lanes of the result are taken from lhs where the mask is set and from rhs otherwise
+    inline f64 select(mask64 m, f64 lhs, f64 rhs) { return { _mm256_blendv_pd(rhs.v, lhs.v, m.v) }; }
+
+    inline f64 max(f64 lhs, f64 rhs) { return { _mm256_max_pd(lhs.v, rhs.v) }; }
+
+    // round to the nearest integer (ties to even)
+    inline f64 round(f64 x) { return { _mm256_round_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+    // base[index] per lane for integral index in [0, 2^31)
+    inline f64 gather(double const* base, f64 index) { return { _mm256_i32gather_pd(base, _mm256_cvttpd_epi32(index.v), 8) }; }
+
+    // 2^n for integral n in [-1022, 1023], built directly from the exponent bits. avx2 has no double to int64
+    // conversion, so n is read out of the mantissa of n + 1.5 * 2^52
+    inline f64 pow2(f64 n)
+    {
+        __m256d magic = _mm256_set1_pd(6755399441055744.0);
+        __m256i integral = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n.v, magic)), _mm256_castpd_si256(magic));
+        __m256i exponent = _mm256_add_epi64(integral, _mm256_set1_epi64x(1023));
+        return { _mm256_castsi256_pd(_mm256_slli_epi64(exponent, 52)) };
+    }
+
+    // the unbiased exponent floor(log2|x|) of a normal x, read directly from the exponent bits (-1023 for 0). the
+    // biased exponent is converted to double by placing it in the mantissa of 2^52
+    inline f64 ilogb(f64 x)
+    {
+        __m256d magic = _mm256_set1_pd(4503599627370496.0);
+        __m256i biased = _mm256_and_si256(_mm256_srli_epi64(_mm256_castpd_si256(x.v), 52), _mm256_set1_epi64x(0x7ff));
+        __m256d exponent = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_castpd_si256(magic))), magic);
+        return { _mm256_sub_pd(exponent, _mm256_set1_pd(1023.0)) };
+    }
+
+    struct mask32
+    {
+        __m256 v;
+
+        unsigned bits() const { return static_cast<unsigned>(_mm256_movemask_ps(v)); }
+    };
+
+    inline mask32 operator|(mask32 lhs, mask32 rhs) { return { _mm256_or_ps(lhs.v, rhs.v) }; }
+    inline mask32 operator&(mask32 lhs, mask32 rhs) { return { _mm256_and_ps(lhs.v, rhs.v) }; }
+
+    struct f32
+    {
+        static constexpr size_t width = 8;
+        using mask = mask32;
+        using value_type = float;
+
+        __m256 v;
+
+        // x is rounded to float, so kernels can pass the same constants to either lane type
+        static f32 broadcast(double x) { return { _mm256_set1_ps(static_cast<float>(x)) }; }
+        static f32 load(float const* src) { return { _mm256_loadu_ps(src) }; }
+        void store(float* dst) const { _mm256_storeu_ps(dst, v); }
+    };
+
+    inline f32 operator+(f32 lhs, f32 rhs) { return { _mm256_add_ps(lhs.v, rhs.v) }; }
+    inline f32 operator-(f32 lhs, f32 rhs) { return { _mm256_sub_ps(lhs.v, rhs.v) }; }
+    inline f32 operator*(f32 lhs, f32 rhs) { return { _mm256_mul_ps(lhs.v, rhs.v) }; }
+    inline f32 operator/(f32 lhs, f32 rhs) { return { _mm256_div_ps(lhs.v, rhs.v) }; }
+
+    inline mask32 operator<(f32 lhs, f32 rhs) { return { _mm256_cmp_ps(lhs.v, rhs.v, _CMP_LT_OQ) }; }
+    inline mask32 operator<=(f32 lhs, f32 rhs) { return { _mm256_cmp_ps(lhs.v, rhs.v, _CMP_LE_OQ) }; }
+    inline mask32 operator>(f32 lhs, f32 rhs) { return { _mm256_cmp_ps(lhs.v, rhs.v, _CMP_GT_OQ) }; }
+    inline mask32 operator>=(f32 lhs, f32 rhs) { return { _mm256_cmp_ps(lhs.v, rhs.v, _CMP_GE_OQ) }; }
+    inline mask32 operator==(f32 lhs, f32 rhs) { return { _mm256_cmp_ps(lhs.v, rhs.v, _CMP_EQ_OQ) }; }
+
+    inline f32 select(mask32 m, f32 lhs, f32 rhs) { return { _mm256_blendv_ps(rhs.v, lhs.v, m.v) }; }
+
+    inline f32 max(f32 lhs, f32 rhs) { return { _mm256_max_ps(lhs.v, rhs.v) }; }
+
+    inline f32 round(f32 x) { return { _mm256_round_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+    // 2^n for integral n in [-126, 127]. unlike double, float converts to int32 directly
+    inline f32 pow2(f32 n)
+    {
+        __m256i exponent = _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127));
+        return { _mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23)) };
+    }
+
+    // the vector type with lanes of T (float or double)
+    template<typename T>
+    using vec = std::conditional_t<std::is_same_v<T, float>, f32, f64>;
+
+}
\ No newline at end of file
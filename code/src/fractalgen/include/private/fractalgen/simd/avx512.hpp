@@ -0,0 +1,132 @@
+#pragma once
+
+#if !defined(__AVX512F__)
+#error "fractalgen/simd/avx512.hpp must be compiled with AVX-512F enabled"
+#endif
+
+#include <cstddef>
+#include <type_traits>
+
+#include <immintrin.h>
+
+namespace fractalgen::simd::avx512
+{
+
+    struct mask64
+    {
+        __mmask8 v;
+
+        unsigned bits() const { return static_cast<unsigned>(v); }
+    };
+
+    inline mask64 operator|(mask64 lhs, mask64 rhs) { return { static_cast<__mmask8>(lhs.v | rhs.v) }; }
+    inline mask64 operator&(mask64 lhs, mask64 rhs) { return { static_cast<__mmask8>(lhs.v & rhs.v) }; }
+
+    struct f64
+    {
+        static constexpr size_t width = 8;
+        using mask = mask64;
+        using value_type = double;
+
+        __m512d v;
+
+        static f64 broadcast(double x) { return { _mm512_set1_pd(x) }; }
+        static f64 load(double const* src) { return { _mm512_loadu_pd(src) }; }
+        void store(double* dst) const { _mm512_storeu_pd(dst, v); }
+    };
+
+    inline f64 operator+(f64 lhs, f64 rhs) { return { _mm512_add_pd(lhs.v, rhs.v) }; }
+    inline f64 operator-(f64 lhs, f64 rhs) { return { _mm512_sub_pd(lhs.v, rhs.v) }; }
+    inline f64 operator*(f64 lhs, f64 rhs) { return { _mm512_mul_pd(lhs.v, rhs.v) }; }
+    inline f64 operator/(f64 lhs, f64 rhs) { return { _mm512_div_pd(lhs.v, rhs.v) }; }
+
+    inline mask64 operator<(f64 lhs, f64 rhs) { return { _mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_LT_OQ) }; }
+    inline mask64 operator<=(f64 lhs, f64 rhs) { return { _mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_LE_OQ) }; }
+    inline mask64 operator>(f64 lhs, f64 rhs) { return { _mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_GT_OQ) }; }
+    inline mask64 operator>=(f64 lhs, f64 rhs) { return { _mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_GE_OQ) }; }
+    inline mask64 operator==(f64 lhs, f64 rhs) { return { _mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_EQ_OQ) }; }
+
+    // lanes of the result are taken from lhs where the mask is set and from rhs otherwise
+    inline f64 select(mask64 m, f64 lhs, f64 rhs) { return { _mm512_mask_blend_pd(m.v, rhs.v, lhs.v) }; }
+
+    inline f64 max(f64 lhs, f64 rhs) { return { _mm512_max_pd(lhs.v, rhs.v) }; }
+
+    // round to the nearest integer (ties to even)
+    inline f64 round(f64 x) { return { _mm512_roundscale_pd(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+    // base[index] per lane for integral index in [0, 2^31)
+    inline f64 gather(double const* base, f64 index) { return { _mm512_i32gather_pd(_mm512_cvttpd_epi32(index.v), base, 8) }; }
+
+    // 2^n for integral n in [-1022, 1023], built directly from the exponent bits. the double to int64 conversion
+    // needs avx512dq, so n is read out of the mantissa of n + 1.5 * 2^52
+    inline f64 pow2(f64 n)
+    {
+        __m512d magic = _mm512_set1_pd(6755399441055744.0);
+        __m512i integral = _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(n.v, magic)), _mm512_castpd_si512(magic));
+        __m512i exponent = _mm512_add_epi64(integral, _mm512_set1_epi64(1023));
+        return { _mm512_castsi512_pd(_mm512_slli_epi64(exponent, 52)) };
+    }
+
+    // the unbiased exponent floor(log2|x|) of a normal x, read directly from the exponent bits (-1023 for 0). unlike
+    // getexp this treats 0 and subnormals exactly like the other instruction sets
+    inline f64 ilogb(f64 x)
+    {
+        __m512d magic = _mm512_set1_pd(4503599627370496.0);
+        __m512i biased = _mm512_and_si512(_mm512_srli_epi64(_mm512_castpd_si512(x.v), 52), _mm512_set1_epi64(0x7ff));
+        __m512d exponent = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(biased, _mm512_castpd_si512(magic))), magic);
+        return { _mm512_sub_pd(exponent, _mm512_set1_pd(1023.0)) };
+    }
+
+    struct mask32
+    {
+        __mmask16 v;
+
+        unsigned bits() const { return static_cast<unsigned>(v); }
+    };
+
+    inline mask32 operator|(mask32 lhs, mask32 rhs) { return { static_cast<__mmask16>(lhs.v | rhs.v) }; }
+    inline mask32 operator&(mask32 lhs, mask32 rhs) { return { static_cast<__mmask16>(lhs.v & rhs.v) }; }
+
+    struct f32
+    {
+        static constexpr size_t width = 16;
+        using mask = mask32;
+        using value_type = float;
+
+        __m512 v;
+
+        // x is rounded to float, so kernels can pass the same constants to either lane type
+        static f32 broadcast(double x) { return { _mm512_set1_ps(static_cast<float>(x)) }; }
+        static f32 load(float const* src) { return { _mm512_loadu_ps(src) }; }
+        void store(float* dst) const { _mm512_storeu_ps(dst, v); }
+    };
+
+    inline f32 operator+(f32 lhs, f32 rhs) { return { _mm512_add_ps(lhs.v, rhs.v) }; }
+    inline f32 operator-(f32 lhs, f32 rhs) { return { _mm512_sub_ps(lhs.v, rhs.v) }; }
+    inline f32 operator*(f32 lhs, f32 rhs) { return { _mm512_mul_ps(lhs.v, rhs.v) }; }
+    inline f32 operator/(f32 lhs, f32 rhs) { return { _mm512_div_ps(lhs.v, rhs.v) }; }
+
+    inline mask32 operator<(f32 lhs, f32 rhs) { return { _mm512_cmp_ps_mask(lhs.v, rhs.v, _CMP_LT_OQ) }; }
+    inline mask32 operator<=(f32 lhs, f32 rhs) { return { _mm512_cmp_ps_mask(lhs.v, rhs.v, _CMP_LE_OQ) }; }
+    inline mask32 operator>(f32 lhs, f32 rhs) { return { _mm512_cmp_ps_mask(lhs.v, rhs.v, _CMP_GT_OQ) }; }
+    inline mask32 operator>=(f32 lhs, f32 rhs) { return { _mm512_cmp_ps_mask(lhs.v, rhs.v, _CMP_GE_OQ) }; }
+    inline mask32 operator==(f32 lhs, f32 rhs) { return { _mm512_cmp_ps_mask(lhs.v, rhs.v, _CMP_EQ_OQ) }; }
+
+    inline f32 select(mask32 m, f32 lhs, f32 rhs) { return { _mm512_mask_blend_ps(m.v, rhs.v, lhs.v) }; }
+
+    inline f32 max(f32 lhs, f32 rhs) { return { _mm512_max_ps(lhs.v, rhs.v) }; }
+
+    inline f32 round(f32 x) { return { _mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+    // 2^n for integral n in [-126, 127]. unlike double, float converts to int32 without avx512dq
+    inline f32 pow2(f32 n)
+    {
+        __m512i exponent = _mm512_add_epi32(_mm512_cvtps_epi32(n.v), _mm512_set1_epi32(127));
+        return { _mm512_castsi512_ps(_mm512_slli_epi32(exponent, 23)) };
+    }
+
+    // the vector type with lanes of T (float or double)
+    template<typename T>
+    using vec = std::conditional_t<std::is_same_v<T, float>, f32, f64>;
+
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string_view>
+
+namespace fractalgen::simd
+{
+
+    /**
+     * Instruction sets that vectorized kernels are compiled for. The AVX variants are only built on x86 targets
+     * and only used when the running cpu (and os) supports them.
+     */
+    enum class isa
+    {
+        scalar,
+        avx2,
+        avx512,
+    };
+
+    std::string_view name(isa target);
+
+    bool supported(isa target);
+
+    // the widest instruction set that is supported on this machine
+    isa best();
+
+    // the instruction set kernels are dispatched to -- defaults to best()
+    isa active();
+    void select(isa target);
+
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace fractalgen::simd::scalar
+{
+
+    /**
+     * A single lane "vector" so that kernels written against the vector interface also compile to the scalar path.
+     * Since the operations are identical, the scalar path produces exactly the same results as the vectorized ones.
+     */
+
+    struct mask64
+    {
+        bool v;
+
+        unsigned bits() const { return v ? 1u : 0u; }
+    };
+
+    inline mask64 operator|(mask64 lhs, mask64 rhs) { return { lhs.v || rhs.v }; }
+    inline mask64 operator&(mask64 lhs, mask64 rhs) { return { lhs.v && rhs.v }; }
+
+    // a single lane mask is the same for either lane type
+    using mask32 = mask64;
+
+    struct f64
+    {
+        static constexpr size_t width = 1;
+        using mask = mask64;
+        using value_type = double;
+
+        double v;
+
+        static f64 broadcast(double x) { return { x }; }
+        static f64 load(double const* src) { return { *src }; }
+        void store(double* dst) const { *dst = v; }
+    };
+
+    inline f64 operator+(f64 lhs, f64 rhs) { return { lhs.v + rhs.v }; }
+    inline f64 operator-(f64 lhs, f64 rhs) { return { lhs.v - rhs.v }; }
+    inline f64 operator*(f64 lhs, f64 rhs) { return { lhs.v * rhs.v }; }
+    inline f64 operator/(f64 lhs, f64 rhs) { return { lhs.v / rhs.v }; }
+
+    inline mask64 operator<(f64 lhs, f64 rhs) { return { lhs.v < rhs.v }; }
+    inline mask64 operator<=(f64 lhs, f64 rhs) { return { lhs.v <= rhs.v }; }
+    inline mask64 operator>(f64 lhs, f64 rhs) { return { lhs.v > rhs.v }; }
+    inline mask64 operator>=(f64 lhs, f64 rhs) { return { lhs.v >= rhs.v }; }
+    inline mask64 operator==(f64 lhs, f64 rhs) { return { lhs.v == rhs.v }; }
+
+    // lanes of the result are taken from lhs where the mask is set and from rhs otherwise
+    inline f64 select(mask64 m, f64 lhs, f64 rhs) { return m.v ? lhs : rhs; }
+
+    inline f64 max(f64 lhs, f64 rhs) { return lhs.v > rhs.v ? lhs : rhs; }
+
+    // round to the nearest integer (ties to even, the default rounding mode)
+    inline f64 round(f64 x) { return { std::nearbyint(x.v) }; }
+
+    // base[index] for integral index in [0, 2^31)
+    inline f64 gather(double const* base, f64 index) { return { base[static_cast<size_t>(index.v)] }; }
+
+    // 2^n for integral n in [-1022, 1023], built directly from the exponent bits
+    inline f64 pow2(f64 n)
+    {
+        uint64_t exponent = static_cast<uint64_t>(static_cast<int64_t>(n.v) + 1023);
+        return { std::bit_cast<double>(exponent << 52) };
+    }
+
+    // the unbiased exponent floor(log2|x|) of a normal x, read directly from the exponent bits (-1023 for 0)
+    inline f64 ilogb(f64 x)
+    {
+        uint64_t biased = (std::bit_cast<uint64_t>(x.v) >> 52) & 0x7ff;
+        return { static_cast<double>(biased) - 1023.0 };
+    }
+
+    struct f32
+    {
+        static constexpr size_t width = 1;
+        using mask = mask32;
+        using value_type = float;
+
+        float v;
+
+        // x is rounded to float, so kernels can pass the same constants to either lane type
+        static f32 broadcast(double x) { return { static_cast<float>(x) }; }
+        static f32 load(float const* src) { return { *src }; }
+        void store(float* dst) const { *dst = v; }
+    };
+
+    inline f32 operator+(f32 lhs, f32 rhs) { return { lhs.v + rhs.v }; }
+    inline f32 operator-(f32 lhs, f32 rhs) { return { lhs.v - rhs.v }; }
+    inline f32 operator*(f32 lhs, f32 rhs) { return { lhs.v * rhs.v }; }
+    inline f32 operator/(f32 lhs, f32 rhs) { return { lhs.v / rhs.v }; }
+
+    inline mask32 operator<(f32 lhs, f32 rhs) { return { lhs.v < rhs.v }; }
+    inline mask32 operator<=(f32 lhs, f32 rhs) { return { lhs.v <= rhs.v }; }
+    inline mask32 operator>(f32 lhs, f32 rhs) { return { lhs.v > rhs.v }; }
+    inline mask32 operator>=(f32 lhs, f32 rhs) { return { lhs.v >= rhs.v }; }
+    inline mask32 operator==(f32 lhs, f32 rhs) { return { lhs.v == rhs.v }; }
+
+    inline f32 select(mask32 m, f32 lhs, f32 rhs) { return m.v ? lhs : rhs; }
+
+    inline f32 max(f32 lhs, f32 rhs) { return lhs.v > rhs.v ? lhs : rhs; }
+
+    inline f32 round(f32 x) { return { std::nearbyintf(x.v) }; }
+
+    // 2^n for integral n in [-126, 127]
+    inline f32 pow2(f32 n)
+    {
+        uint32_t exponent = static_cast<uint32_t>(static_cast<int32_t>(n.v) + 127);
+        return { std::bit_cast<float>(exponent << 23) };
+    }
+
+    // the vector type with lanes of T (float or double)
+    template<typename T>
+    using vec = std::conditional_t<std::is_same_v<T, float>, f32, f64>;
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace fractalgen::threading
+{
+
+    /**
+     * Per-worker counters of completed work. Each worker only ever writes its own counter (on its own cache line)
+     * so reporting progress costs O(workers) no matter how much work there is.
+     */
+    class progress
+    {
+    public:
+
+        explicit progress(size_t workers) : m_counters(workers) {}
+
+        void add(size_t worker, size_t count)
+        {
+            m_counters[worker].value.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        size_t completed() const
+        {
+            size_t total = 0;
+            for (counter const& c : m_counters) { total += c.value.load(std::memory_order_relaxed); }
+            return total;
+        }
+
+    private:
+
+        struct alignas(64) counter
+        {
+            std::atomic<size_t> value = 0;
+        };
+
+        std::vector<counter> m_counters;
+
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fractalgen::threading
+{
+
+    /**
+     * A fixed set of worker threads that lives for the duration of the process. Tasks are run in the order they
+     * are submitted by whichever worker is free first.
+     */
+    class thread_pool
+    {
+    public:
+
+        // a count of 0 sizes the pool to std::thread::hardware_concurrency()
+        explicit thread_pool(size_t count = 0);
+        ~thread_pool();
+
+        thread_pool(thread_pool const&) = delete;
+        thread_pool& operator=(thread_pool const&) = delete;
+
+        size_t size() const { return m_threads.size(); }
+
+        std::future<void> submit(std::function<void()> task);
+
+    private:
+
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::packaged_task<void()>> m_tasks;
+        bool m_stopping;
+
+        void run();
+
+    };
+
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace fractalgen::threading
+{
+
+    /**
+     * A set of per-worker deques. A worker pops items from the front of its own deque and, once that is empty,
+     * steals items from the back of the other workers' deques. Stealing from the opposite end keeps each worker
+     * walking through its own items in order while thieves take the items that are furthest from being processed.
+     *
+     * Workers may push new items while processing one. Each push is counted as pending until a worker calls finish()
+     * for it, so an empty queue can be told apart from one that is done: a worker that pushes children before
+     * finishing its own item keeps pending() above zero until every item has been processed.
+     */
+    template<typename T>
+    class work_stealing_queue
+    {
+    public:
+
+        explicit work_stealing_queue(size_t workers) : m_deques(workers) {}
+
+        size_t workers() const { return m_deques.size(); }
+
+        void push(size_t worker, T const& item)
+        {
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            deque& d = m_deques[worker];
+            std::lock_guard<std::mutex> lock(d.mutex);
+            d.items.push_back(item);
+        }
+
+        // mark a popped item as processed
+        void finish() { m_pending.fetch_sub(1, std::memory_order_acq_rel); }
+
+        // the number of items that have been pushed but not finished
+        size_t pending() const { return m_pending.load(std::memory_order_acquire); }
+
+        // returns std::nullopt only once every deque is empty
+        std::optional<T> pop(size_t worker)
+        {
+            if (std::optional<T> item = pop_front(m_deques[worker])) { return item; }
+
+            size_t count = m_deques.size();
+            for (size_t offset = 1; offset < count; ++offset)
+            {
+                if (std::optional<T> item = pop_back(m_deques[(worker + offset) % count])) { return item; }
+            }
+            return std::nullopt;
+        }
+
+    private:
+
+        // align to a cache line so workers don't contend on each other's locks
+        struct alignas(64) deque
+        {
+            std::mutex mutex;
+            std::deque<T> items;
+        };
+
+        std::vector<deque> m_deques;
+        std::atomic<size_t> m_pending = 0;
+
+        static std::optional<T> pop_front(deque& d)
+        {
+            std::lock_guard<std::mutex> lock(d.mutex);
+            if (d.items.empty()) { return std::nullopt; }
+            T item = d.items.front();
+            d.items.pop_front();
+            return item;
+        }
+
+        static std::optional<T> pop_back(deque& d)
+        {
+            std::lock_guard<std::mutex> lock(d.mutex);
+            if (d.items.empty()) { return std::nullopt; }
+            T item = d.items.back();
+            d.items.pop_back();
+            return item;
+        }
+
+    };
+
+}
\ No newline at end of file